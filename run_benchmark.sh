@@ -2,6 +2,12 @@
 
 # Benchmark para as versões do Jogo da Vida
 
+# Uso:
+#   ./run_benchmark.sh                  benchmark completo (varredura padrão de tamanhos)
+#   ./run_benchmark.sh escalabilidade   suíte de escalabilidade forte e fraca
+#   ./run_benchmark.sh kernels          comparação dos kernels (-k) seq e OpenMP
+MODO="${1:-completo}"
+
 # Configurações
 RESULTS_DIR="results"
 TIMESTAMP=$(date +%Y%m%d_%H%M%S)
@@ -53,7 +59,13 @@ EOF
 log "Iniciando benchmark completo..."
 
 # Verificar se os executáveis existem
-EXECUTABLES=("jogodavida" "jogodavidaomp" "jogodavida_cuda" "jogodavidaomp_gpu")
+if [[ "$MODO" == "escalabilidade" ]]; then
+    EXECUTABLES=("jogodavida" "jogodavidaomp" "jogodavidampi")
+elif [[ "$MODO" == "kernels" ]]; then
+    EXECUTABLES=("jogodavida" "jogodavidaomp")
+else
+    EXECUTABLES=("jogodavida" "jogodavidaomp" "jogodavida_cuda" "jogodavidaomp_gpu")
+fi
 MISSING_EXEC=()
 
 for exec in "${EXECUTABLES[@]}"; do
@@ -68,6 +80,9 @@ if [[ ${#MISSING_EXEC[@]} -gt 0 ]]; then
     exit 1
 fi
 
+# As contagens de threads são fixadas aqui: ignora o cache de autotuning (-T)
+export JOGODAVIDA_TUNING=/dev/null
+
 # Configurações de teste
 THREAD_COUNTS=(1 2 4 8 16)
 MPI_PROCESSES=(1 2 4 8)
@@ -116,6 +131,214 @@ run_test() {
     fi
 }
 
+# =============================================================================
+# Suíte de escalabilidade
+# =============================================================================
+# Escalabilidade forte: tamanhos fixos, variando threads/processos.
+# Escalabilidade fraca: área do tabuleiro cresce com p (tam = base * sqrt(p)).
+# Como o número de gerações também cresce com tam (4*(tam-3)), a escalabilidade
+# fraca compara o tempo por geração (t_ger = comp / gerações).
+read -r -a STRONG_SIZES <<< "${STRONG_SIZES:-1024 2048}"
+WEAK_BASE="${WEAK_BASE:-512}"
+SCALING_TIMEOUT=3600
+MPIRUN_FLAGS="${MPIRUN_FLAGS:-}"
+CSV_FILE="${RESULTS_DIR}/escalabilidade_${TIMESTAMP}.csv"
+
+# Executa um caso REPETITIONS vezes e imprime "init comp fim tot" médios
+run_scaling_case() {
+    local tam="$1"
+    local exec_cmd="$2"
+    local log_filename="$3"
+    local line
+
+    for ((rep=1; rep<=REPETITIONS; rep++)); do
+        if timeout "${SCALING_TIMEOUT}s" bash -c "$exec_cmd" >> "$log_filename" 2>&1; then
+            # Saída termina com "**RESULTADO ...**" seguido da linha de tempos
+            if ! tail -n 2 "$log_filename" | grep -q "RESULTADO CORRETO"; then
+                warning "    ✗ Resultado errado (tam=$tam)" >&2
+            fi
+            tail -n 1 "$log_filename"
+        else
+            warning "    ✗ Falha ou timeout (tam=$tam)" >&2
+        fi
+    done | grep "tam=$tam;.*tot=" | tr ',' ' ' | awk '{
+        for (i = 1; i <= NF; i++) {
+            split($i, kv, "=")
+            if (kv[1] == "init") init += kv[2]
+            if (kv[1] == "comp") comp += kv[2]
+            if (kv[1] == "fim") fim += kv[2]
+            if (kv[1] == "tot") { tot += kv[2]; n++ }
+        }
+    } END {
+        if (n > 0) printf "%.7f %.7f %.7f %.7f\n", init / n, comp / n, fim / n, tot / n
+    }'
+}
+
+# Registra uma linha no CSV com eficiência e fração serial de Karp-Flatt.
+# Tudo sobre o tempo de computação (comp): o tot inclui os dumps do tabuleiro
+# que o MPI imprime e a versão sequencial não, e fica só como coluna extra.
+# Forte: S = comp_seq / comp_p, E = S / p. Fraca: E = t_ger(1) / t_ger(p), S = p * E.
+# Karp-Flatt: e = (1/S - 1/p) / (1 - 1/p), definida para p > 1.
+record_scaling() {
+    local tipo="$1" versao="$2" p="$3" tam="$4" tempos="$5" base="$6"
+    local init comp fim tot
+
+    read -r init comp fim tot <<< "$tempos"
+    if [[ -z "$tot" ]]; then
+        echo "$tipo,$versao,$p,$tam,,,,,,,," >> "$CSV_FILE"
+        return
+    fi
+
+    awk -v tipo="$tipo" -v versao="$versao" -v p="$p" -v tam="$tam" \
+        -v init="$init" -v comp="$comp" -v fim="$fim" -v tot="$tot" -v base="$base" 'BEGIN {
+        tger = comp / (4 * (tam - 3))
+        if (tipo == "forte") { s = base / comp; e = s / p }
+        else { e = base / tger; s = p * e }
+        kf = (p > 1) ? sprintf("%.4f", (1 / s - 1 / p) / (1 - 1 / p)) : ""
+        printf "%s,%s,%d,%d,%s,%s,%s,%s,%.9f,%.3f,%.3f,%s\n", tipo, versao, p, tam, init, comp, fim, tot, tger, s, e, kf
+    }' >> "$CSV_FILE"
+
+    tail -1 "$CSV_FILE" | awk -F, '{
+        printf "    %-6s %-6s p=%-3s tam=%-6s comp=%ss tot=%ss speedup=%sx eficiencia=%s karp-flatt=%s\n", $1, $2, $3, $4, $6, $8, $10, $11, $12
+    }' | tee -a "$RESULTS_FILE"
+}
+
+# Comando de execução de uma versão com p threads/processos e um tamanho
+scaling_cmd() {
+    local versao="$1" p="$2" tam="$3"
+    case "$versao" in
+        OpenMP) echo "OMP_NUM_THREADS=$p ./exec/jogodavidaomp $tam" ;;
+        MPI)    echo "mpirun $MPIRUN_FLAGS -np $p ./exec/jogodavidampi $tam" ;;
+    esac
+}
+
+# Contagens de threads/processos de uma versão
+scaling_counts() {
+    if [[ "$1" == "OpenMP" ]]; then
+        echo "${THREAD_COUNTS[*]}"
+    else
+        echo "${MPI_PROCESSES[*]}"
+    fi
+}
+
+run_scaling_suite() {
+    local versao tam p tempos base tger1 log_filename
+    local versoes=("OpenMP")
+
+    if command -v mpirun &> /dev/null; then
+        versoes+=("MPI")
+    else
+        warning "MPI não disponível - escalabilidade apenas com OpenMP"
+    fi
+
+    echo "tipo,versao,p,tam,init,comp,fim,tot,t_ger,speedup,eficiencia,karp_flatt" > "$CSV_FILE"
+
+    log "=== ESCALABILIDADE FORTE: tamanhos ${STRONG_SIZES[*]} ==="
+    for tam in "${STRONG_SIZES[@]}"; do
+        log_filename="${LOG_PREFIX}_forte_Sequential_${tam}.log"
+        log "Executando: Sequential (tam=$tam)"
+        tempos=$(run_scaling_case "$tam" "./exec/jogodavida $tam" "$log_filename")
+        base=$(awk '{print $2}' <<< "$tempos")
+        record_scaling "forte" "Seq" 1 "$tam" "$tempos" "$base"
+        if [[ -z "$base" ]]; then
+            warning "Sem baseline sequencial para tam=$tam - pulando"
+            continue
+        fi
+
+        for versao in "${versoes[@]}"; do
+            for p in $(scaling_counts "$versao"); do
+                log "Executando: $versao (p=$p, tam=$tam)"
+                log_filename="${LOG_PREFIX}_forte_${versao}_${p}_${tam}.log"
+                tempos=$(run_scaling_case "$tam" "$(scaling_cmd "$versao" "$p" "$tam")" "$log_filename")
+                record_scaling "forte" "$versao" "$p" "$tam" "$tempos" "$base"
+            done
+        done
+    done
+
+    log "=== ESCALABILIDADE FRACA: base tam=$WEAK_BASE, tam = base * sqrt(p) ==="
+    for versao in "${versoes[@]}"; do
+        tger1=""
+        for p in $(scaling_counts "$versao"); do
+            tam=$(awk -v b="$WEAK_BASE" -v p="$p" 'BEGIN {printf "%d", b * sqrt(p) + 0.5}')
+            log "Executando: $versao (p=$p, tam=$tam)"
+            log_filename="${LOG_PREFIX}_fraca_${versao}_${p}_${tam}.log"
+            tempos=$(run_scaling_case "$tam" "$(scaling_cmd "$versao" "$p" "$tam")" "$log_filename")
+            if [[ -z "$tger1" ]]; then
+                # Primeira contagem da lista (normalmente p=1) e a referencia
+                tger1=$(awk -v tam="$tam" '{if (NF == 4) printf "%.9f", $2 / (4 * (tam - 3))}' <<< "$tempos")
+            fi
+            record_scaling "fraca" "$versao" "$p" "$tam" "$tempos" "${tger1:-0}"
+        done
+    done
+
+    success "Suíte de escalabilidade concluída: $CSV_FILE"
+}
+
+# =============================================================================
+# Comparação de kernels
+# =============================================================================
+# Roda cada kernel (-k) das versões sequencial e OpenMP nos mesmos tamanhos e
+# registra o ganho de comp em relação ao kernel classico da mesma versão.
+read -r -a KERNEL_SIZES <<< "${KERNEL_SIZES:-256 512 1024 2048}"
+read -r -a KERNELS <<< "${KERNELS:-classico morton colunas}"
+KERNELS_CSV="${RESULTS_DIR}/kernels_${TIMESTAMP}.csv"
+
+run_kernel_suite() {
+    local versao cmd tam kernel tempos base log_filename threads
+    local omp_threads="${KERNEL_THREADS:-${THREAD_COUNTS[-1]}}"
+
+    echo "versao,kernel,threads,tam,init,comp,fim,tot,ganho_comp" > "$KERNELS_CSV"
+
+    for versao in Seq OpenMP; do
+        for tam in "${KERNEL_SIZES[@]}"; do
+            base=""
+            for kernel in "${KERNELS[@]}"; do
+                if [[ "$versao" == "Seq" ]]; then
+                    threads=1
+                    cmd="./exec/jogodavida -k $kernel $tam"
+                else
+                    threads="$omp_threads"
+                    cmd="OMP_NUM_THREADS=$threads ./exec/jogodavidaomp -k $kernel $tam"
+                fi
+                log "Executando: $versao -k $kernel (tam=$tam)"
+                log_filename="${LOG_PREFIX}_kernel_${versao}_${kernel}_${tam}.log"
+                tempos=$(run_scaling_case "$tam" "$cmd" "$log_filename")
+                if [[ "$kernel" == "classico" ]]; then
+                    base=$(awk '{print $2}' <<< "$tempos")
+                fi
+                awk -v versao="$versao" -v kernel="$kernel" -v th="$threads" -v tam="$tam" \
+                    -v tempos="$tempos" -v base="$base" 'BEGIN {
+                    n = split(tempos, t, " ")
+                    if (n < 4) { printf "%s,%s,%d,%d,,,,,\n", versao, kernel, th, tam; exit }
+                    g = (base != "" && t[2] > 0) ? sprintf("%.3f", base / t[2]) : ""
+                    printf "%s,%s,%d,%d,%s,%s,%s,%s,%s\n", versao, kernel, th, tam, t[1], t[2], t[3], t[4], g
+                }' >> "$KERNELS_CSV"
+                tail -1 "$KERNELS_CSV" | awk -F, '{
+                    printf "    %-6s %-8s tam=%-6s comp=%ss ganho=%sx\n", $1, $2, $4, $6, $9
+                }' | tee -a "$RESULTS_FILE"
+            done
+        done
+    done
+
+    success "Comparação de kernels concluída: $KERNELS_CSV"
+}
+
+if [[ "$MODO" == "kernels" ]]; then
+    log "Configuração da comparação de kernels:"
+    log "  - Kernels: ${KERNELS[*]}"
+    log "  - Tamanhos: ${KERNEL_SIZES[*]}"
+    run_kernel_suite
+    exit 0
+fi
+
+if [[ "$MODO" == "escalabilidade" ]]; then
+    log "Configuração da escalabilidade:"
+    log "  - Forte: tamanhos ${STRONG_SIZES[*]}"
+    log "  - Fraca: tamanho base $WEAK_BASE"
+    run_scaling_suite
+    exit 0
+fi
+
 # Versão Sequencial (baseline)
 log "=== TESTE 1: Versão Sequencial ==="
 run_test "Sequential" "baseline" "./exec/jogodavida"
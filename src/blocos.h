@@ -0,0 +1,208 @@
+/* Layout em blocos (Morton) compartilhado pelas versoes sequencial e OpenMP:
+   o tabuleiro e dividido em blocos de bloco x bloco celulas, cada um com sua
+   propria borda fantasma ((bloco + 2)^2 inteiros), armazenados em ordem Z.
+   O stencil de um bloco cabe na cache e blocos vizinhos no plano ficam
+   proximos na memoria. Aqui ficam o layout e os kernels de um bloco; cada
+   versao percorre os blocos com o seu proprio laco (serial ou paralelo). */
+#ifndef BLOCOS_H
+#define BLOCOS_H
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    int tam, bloco;
+    int nb;       // blocos por lado
+    int lb;       // lado do bloco com borda (bloco + 2)
+    int *ordem;   // ordem[bi * nb + bj] = posicao Z do bloco
+    int *bi, *bj; // coordenadas do bloco na posicao Z k
+    int *cel;     // nb * nb blocos de lb * lb celulas
+} TabulBlocos;
+
+/* Intercala os bits de i e j (chave de Morton) */
+static inline unsigned int ChaveMorton(unsigned int i, unsigned int j) {
+    unsigned int chave = 0;
+    int b;
+
+    for (b = 0; b < 16; b++) {
+        chave |= ((i >> b) & 1u) << (2 * b + 1) | ((j >> b) & 1u) << (2 * b);
+    }
+    return chave;
+}
+
+static inline int CompararMorton(const void *a, const void *b) {
+    unsigned int ka = ((const unsigned int *)a)[0], kb = ((const unsigned int *)b)[0];
+
+    return (ka > kb) - (ka < kb);
+}
+
+static inline void LiberarBlocos(TabulBlocos *tb) {
+    free(tb->ordem);
+    free(tb->bi);
+    free(tb->bj);
+    free(tb->cel);
+}
+
+/* Aloca e ordena os blocos; em erro libera o que ja foi alocado */
+static inline int CriarBlocos(TabulBlocos *tb, int tam, int bloco) {
+    unsigned int (*chaves)[2];
+    int k, n;
+
+    tb->tam = tam;
+    tb->bloco = bloco < tam ? bloco : tam;
+    tb->nb = (tam + tb->bloco - 1) / tb->bloco;
+    tb->lb = tb->bloco + 2;
+    n = tb->nb * tb->nb;
+
+    tb->ordem = (int *)malloc(n * sizeof(int));
+    tb->bi = (int *)malloc(n * sizeof(int));
+    tb->bj = (int *)malloc(n * sizeof(int));
+    tb->cel = (int *)calloc((size_t)n * tb->lb * tb->lb, sizeof(int));
+    chaves = malloc(n * sizeof(*chaves));
+    if (!tb->ordem || !tb->bi || !tb->bj || !tb->cel || !chaves) {
+        free(chaves);
+        LiberarBlocos(tb);
+        tb->ordem = tb->bi = tb->bj = tb->cel = NULL;
+        return -1;
+    }
+
+    // Ordena os blocos pela chave de Morton de (bi, bj)
+    for (k = 0; k < n; k++) {
+        chaves[k][0] = ChaveMorton(k / tb->nb, k % tb->nb);
+        chaves[k][1] = k;
+    }
+    qsort(chaves, n, sizeof(*chaves), CompararMorton);
+    for (k = 0; k < n; k++) {
+        tb->bi[k] = chaves[k][1] / tb->nb;
+        tb->bj[k] = chaves[k][1] % tb->nb;
+        tb->ordem[chaves[k][1]] = k;
+    }
+
+    free(chaves);
+    return 0;
+}
+
+/* Bloco (bi, bj) ou NULL fora do tabuleiro */
+static inline int *Bloco(TabulBlocos *tb, int bi, int bj) {
+    if (bi < 0 || bj < 0 || bi >= tb->nb || bj >= tb->nb) {
+        return NULL;
+    }
+    return tb->cel + (size_t)tb->ordem[bi * tb->nb + bj] * tb->lb * tb->lb;
+}
+
+/* Conversao do bloco k de/para o layout linha a linha de largura ld
+   (E/S e Correto) */
+static inline void ParaBloco(const int *tabul, int ld, TabulBlocos *tb, int k) {
+    int a, b, tam = tb->tam, B = tb->bloco, lb = tb->lb;
+    int *t = tb->cel + (size_t)k * lb * lb;
+    int i0 = tb->bi[k] * B, j0 = tb->bj[k] * B;
+
+    for (a = 1; a <= B && i0 + a <= tam; a++) {
+        for (b = 1; b <= B && j0 + b <= tam; b++) {
+            t[a * lb + b] = tabul[(size_t)(i0 + a) * ld + j0 + b];
+        }
+    }
+}
+
+static inline void DeBloco(TabulBlocos *tb, int k, int *tabul, int ld) {
+    int a, b, tam = tb->tam, B = tb->bloco, lb = tb->lb;
+    const int *t = tb->cel + (size_t)k * lb * lb;
+    int i0 = tb->bi[k] * B, j0 = tb->bj[k] * B;
+
+    for (a = 1; a <= B && i0 + a <= tam; a++) {
+        for (b = 1; b <= B && j0 + b <= tam; b++) {
+            tabul[(size_t)(i0 + a) * ld + j0 + b] = t[a * lb + b];
+        }
+    }
+}
+
+/* Copia para a borda fantasma do bloco k as celulas dos 8 blocos vizinhos.
+   Bordas no limite do tabuleiro ficam sempre zeradas. */
+static inline void AtualizarBordas(TabulBlocos *tb, int k) {
+    int B = tb->bloco, lb = tb->lb, bi = tb->bi[k], bj = tb->bj[k], a;
+    int *t = tb->cel + (size_t)k * lb * lb;
+    int *v;
+
+    if ((v = Bloco(tb, bi - 1, bj))) {
+        memcpy(&t[1], &v[B * lb + 1], B * sizeof(int));
+    }
+    if ((v = Bloco(tb, bi + 1, bj))) {
+        memcpy(&t[(B + 1) * lb + 1], &v[lb + 1], B * sizeof(int));
+    }
+    if ((v = Bloco(tb, bi, bj - 1))) {
+        for (a = 1; a <= B; a++) {
+            t[a * lb] = v[a * lb + B];
+        }
+    }
+    if ((v = Bloco(tb, bi, bj + 1))) {
+        for (a = 1; a <= B; a++) {
+            t[a * lb + B + 1] = v[a * lb + 1];
+        }
+    }
+    if ((v = Bloco(tb, bi - 1, bj - 1))) {
+        t[0] = v[B * lb + B];
+    }
+    if ((v = Bloco(tb, bi - 1, bj + 1))) {
+        t[B + 1] = v[B * lb + 1];
+    }
+    if ((v = Bloco(tb, bi + 1, bj - 1))) {
+        t[(B + 1) * lb] = v[lb + B];
+    }
+    if ((v = Bloco(tb, bi + 1, bj + 1))) {
+        t[(B + 1) * lb + B + 1] = v[lb + 1];
+    }
+}
+
+/* Stencil sobre na x nbb celulas de um bloco de lado com borda lb */
+static inline __attribute__((always_inline)) void UmaVidaBlocoCorpo(const int *restrict t, int *restrict o, int lb, int na, int nbb) {
+    int a, b, vizviv;
+
+    for (a = 1; a <= na; a++) {
+        for (b = 1; b <= nbb; b++) {
+            vizviv = t[(a - 1) * lb + b - 1] + t[(a - 1) * lb + b] + t[(a - 1) * lb + b + 1] +
+                     t[a * lb + b - 1] + t[a * lb + b + 1] +
+                     t[(a + 1) * lb + b - 1] + t[(a + 1) * lb + b] + t[(a + 1) * lb + b + 1];
+            o[a * lb + b] = (vizviv == 3) | (t[a * lb + b] & (vizviv == 2));
+        }
+    }
+}
+
+/* Evolui o bloco k; em blocos da ultima linha/coluna so as celulas dentro
+   do tabuleiro sao calculadas (as demais continuam mortas). Blocos completos
+   dos lados usuais usam versoes com o lado constante. */
+static inline void UmaVidaBloco(TabulBlocos *in, TabulBlocos *out, int k) {
+    int lb = in->lb, B = in->bloco;
+    int na = in->tam - in->bi[k] * B < B ? in->tam - in->bi[k] * B : B;
+    int nbb = in->tam - in->bj[k] * B < B ? in->tam - in->bj[k] * B : B;
+    const int *t = in->cel + (size_t)k * lb * lb;
+    int *o = out->cel + (size_t)k * lb * lb;
+
+    if (na == B && nbb == B && B == 32) {
+        UmaVidaBlocoCorpo(t, o, 34, 32, 32);
+    }
+    else if (na == B && nbb == B && B == 64) {
+        UmaVidaBlocoCorpo(t, o, 66, 64, 64);
+    }
+    else if (na == B && nbb == B && B == 128) {
+        UmaVidaBlocoCorpo(t, o, 130, 128, 128);
+    }
+    else {
+        UmaVidaBlocoCorpo(t, o, lb, na, nbb);
+    }
+}
+
+/* Celulas vivas do bloco k (populacao da telemetria, fora do stencil);
+   as celulas fora do tabuleiro estao sempre mortas */
+static inline int VivasBloco(TabulBlocos *tb, int k) {
+    int a, b, B = tb->bloco, lb = tb->lb, vivas = 0;
+    const int *t = tb->cel + (size_t)k * lb * lb;
+
+    for (a = 1; a <= B; a++) {
+        for (b = 1; b <= B; b++) {
+            vivas += t[a * lb + b];
+        }
+    }
+    return vivas;
+}
+
+#endif
@@ -1,10 +1,46 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
 #include <sys/time.h>
-#define ind2d(i, j) (i) * (tam + 2) + j
+#include "blocos.h"
+#define ind2d(i, j) (i) * ld + j
 #define POWMIN 3
 #define POWMAX 10
 
+// Kernels selecionaveis com -k
+#define KERNEL_CLASSICO 0
+#define KERNEL_MORTON 1
+#define KERNEL_COLUNAS 2
+#define BLOCO_PADRAO 64
+
+// Fluxo de geracoes (-g), lido por jogodavida_replay
+#define FLUXO_MAGICO 0x5344564au // "JVDS"
+#define FLUXO_FIM 0x4944564au    // "JVDI"
+#define FLUXO_VERSAO 1
+#define QUADRO_DELTA 1
+#define QUADRO_CHAVE 2
+#define QUADRO_INDICE 3
+#define FIM_LINHAS 0xffffffffu
+#define INTERVALO_CHAVE 64
+
+/* Largura de linha (stride) do tabuleiro. Com -DLARGURA_POT2 a linha e
+   preenchida ate a proxima potencia de dois, e o calculo de indices vira
+   deslocamento de bits; sem a opcao, a largura e tam + 2. */
+static inline int Largura(int tam) {
+#ifdef LARGURA_POT2
+    int ld = 1;
+
+    while (ld < tam + 2) {
+        ld <<= 1;
+    }
+    return ld;
+#else
+    return tam + 2;
+#endif
+}
+
 
 double wall_time(void) {
     struct timeval tv;
@@ -14,7 +50,157 @@ double wall_time(void) {
     return (tv.tv_sec + tv.tv_usec / 1000000.0);
 }
 
-void UmaVida(int *tabulIn, int *tabulOut, int tam) {
+/* ---------------------------------------------------------------------------
+   Gravacao do fluxo de geracoes. Arquivo binario em palavras de 32 bits
+   (ordem de bytes do host):
+     cabecalho: FLUXO_MAGICO, FLUXO_VERSAO, tam, intervalo entre chaves
+     quadro:    tipo, geracao, n, n palavras de linhas
+     linhas:    (i, nruns, (j, comprimento) x nruns)..., FIM_LINHAS
+     indice:    QUADRO_INDICE, nchaves, (geracao, offset 64 bits) x nchaves
+     rodape:    offset 64 bits do indice, FLUXO_FIM
+   Um quadro delta traz os runs de celulas que mudaram na geracao; um quadro
+   chave (geracao 0 e a cada intervalo) traz os runs de celulas vivas.
+   --------------------------------------------------------------------------- */
+
+typedef struct {
+    FILE *f;
+    int tam, intervalo, geracao;
+    uint32_t *buf; // quadro em montagem
+    size_t n, cap;
+    size_t inicio; // posicao do quadro em buf
+    uint64_t offset;
+    uint32_t *chave_ger; // indice das chaves
+    uint64_t *chave_off;
+    int nchaves, capchaves;
+    int *zeros; // linha morta, base dos quadros chave
+    uint8_t *linha_mudou; // linha i mudou na ultima geracao (0 e tam + 1: bordas)
+} Gravador;
+
+static inline void Emitir(Gravador *g, uint32_t palavra) {
+    if (g->n == g->cap) {
+        g->cap = g->cap ? 2 * g->cap : 4096;
+        g->buf = (uint32_t *)realloc(g->buf, g->cap * sizeof(uint32_t));
+        if (!g->buf) {
+            printf("Erro de alocacao de memoria\n");
+            exit(1);
+        }
+    }
+    g->buf[g->n++] = palavra;
+}
+
+/* Runs das colunas 1..n em que velha e nova diferem */
+static void EmitirLinha(Gravador *g, int i, const int *velha, const int *nova, int n) {
+    size_t pos;
+    int j, j0;
+
+    Emitir(g, i);
+    pos = g->n;
+    Emitir(g, 0);
+    for (j = 0; j < n; j++) {
+        if (velha[j] != nova[j]) {
+            for (j0 = j; j < n && velha[j] != nova[j]; j++)
+                ;
+            Emitir(g, j0 + 1);
+            Emitir(g, j - j0);
+            g->buf[pos]++;
+        }
+    }
+}
+
+static void IniciarQuadro(Gravador *g, int tipo, int geracao) {
+    g->inicio = g->n;
+    Emitir(g, tipo);
+    Emitir(g, geracao);
+    Emitir(g, 0);
+}
+
+static int FecharQuadro(Gravador *g) {
+    Emitir(g, FIM_LINHAS);
+    g->buf[g->inicio + 2] = g->n - g->inicio - 3;
+    if (fwrite(g->buf, sizeof(uint32_t), g->n, g->f) != g->n) {
+        return -1;
+    }
+    g->offset += g->n * sizeof(uint32_t);
+    g->n = 0;
+    return 0;
+}
+
+static int GravarChave(Gravador *g, const int *tabul) {
+    int i, ld = Largura(g->tam);
+
+    if (g->nchaves == g->capchaves) {
+        g->capchaves = g->capchaves ? 2 * g->capchaves : 64;
+        g->chave_ger = (uint32_t *)realloc(g->chave_ger, g->capchaves * sizeof(uint32_t));
+        g->chave_off = (uint64_t *)realloc(g->chave_off, g->capchaves * sizeof(uint64_t));
+        if (!g->chave_ger || !g->chave_off) {
+            return -1;
+        }
+    }
+    g->chave_ger[g->nchaves] = g->geracao;
+    g->chave_off[g->nchaves++] = g->offset;
+
+    IniciarQuadro(g, QUADRO_CHAVE, g->geracao);
+    for (i = 1; i <= g->tam; i++) {
+        if (memcmp(&tabul[ind2d(i, 1)], g->zeros, g->tam * sizeof(int)) != 0) {
+            EmitirLinha(g, i, g->zeros, &tabul[ind2d(i, 1)], g->tam);
+        }
+    }
+    return FecharQuadro(g);
+}
+
+/* Abre o arquivo, grava o cabecalho e a chave da geracao 0 */
+int AbrirGravacao(Gravador *g, const char *caminho, int tam, int intervalo, const int *tabul) {
+    uint32_t cab[4] = {FLUXO_MAGICO, FLUXO_VERSAO, tam, intervalo};
+
+    memset(g, 0, sizeof(*g));
+    g->tam = tam;
+    g->intervalo = intervalo;
+    g->zeros = (int *)calloc(tam, sizeof(int));
+    g->linha_mudou = (uint8_t *)calloc(tam + 2, sizeof(uint8_t));
+    g->f = fopen(caminho, "wb");
+    if (!g->zeros || !g->linha_mudou || !g->f || fwrite(cab, sizeof(cab), 1, g->f) != 1) {
+        return -1;
+    }
+    // Na primeira geracao qualquer linha pode mudar
+    memset(g->linha_mudou + 1, 1, tam);
+    g->offset = sizeof(cab);
+    return GravarChave(g, tabul);
+}
+
+/* Grava o indice das chaves e o rodape e fecha o arquivo */
+int FecharGravacao(Gravador *g) {
+    uint32_t fim[3];
+    uint64_t off_indice = g->offset;
+    int k, erro = 0;
+
+    Emitir(g, QUADRO_INDICE);
+    Emitir(g, g->nchaves);
+    for (k = 0; k < g->nchaves; k++) {
+        Emitir(g, g->chave_ger[k]);
+        Emitir(g, (uint32_t)g->chave_off[k]);
+        Emitir(g, (uint32_t)(g->chave_off[k] >> 32));
+    }
+    fim[0] = (uint32_t)off_indice;
+    fim[1] = (uint32_t)(off_indice >> 32);
+    fim[2] = FLUXO_FIM;
+    if (fwrite(g->buf, sizeof(uint32_t), g->n, g->f) != g->n || fwrite(fim, sizeof(fim), 1, g->f) != 1) {
+        erro = -1;
+    }
+    if (fclose(g->f) != 0) {
+        erro = -1;
+    }
+    free(g->buf);
+    free(g->chave_ger);
+    free(g->chave_off);
+    free(g->zeros);
+    free(g->linha_mudou);
+    return erro;
+}
+
+/* Corpo do kernel, sempre expandido no chamador: quando tam e ld sao
+   constantes (versoes especializadas abaixo), o compilador conhece os
+   strides e os limites dos loops e pode desenrolar e vetorizar */
+static inline __attribute__((always_inline)) void UmaVidaCorpo(const int *restrict tabulIn, int *restrict tabulOut, int tam, int ld) {
     int i, j, vizviv;
 
     for (i = 1; i <= tam; i++) {
@@ -23,26 +209,188 @@ void UmaVida(int *tabulIn, int *tabulOut, int tam) {
                      tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
                      tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
                      tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
-            if (tabulIn[ind2d(i, j)] && vizviv < 2) {
-                tabulOut[ind2d(i, j)] = 0;
-            }
-            else if (tabulIn[ind2d(i, j)] && vizviv > 3) {
-                tabulOut[ind2d(i, j)] = 0;
-            }
-            else if (!tabulIn[ind2d(i, j)] && vizviv == 3) {
-                tabulOut[ind2d(i, j)] = 1;
-            }
-            else {
-                tabulOut[ind2d(i, j)] = tabulIn[ind2d(i, j)];
-            }
+
+            // Viva com 2 ou 3 vizinhos ou morta com 3 vizinhos
+            tabulOut[ind2d(i, j)] = (vizviv == 3) | (tabulIn[ind2d(i, j)] & (vizviv == 2));
         }
     }
 }
 
+/* Corpo do kernel de gravacao: o mesmo laco interno do kernel classico,
+   que continua intacto para as execucoes sem gravacao. Uma linha so pode
+   mudar na geracao g + 1 se ela ou uma vizinha mudou na geracao g; apenas
+   essas linhas candidatas sao comparadas (memcmp com a linha recem-escrita
+   ainda na cache) e codificadas, as demais nao custam nada alem do
+   stencil. */
+static inline __attribute__((always_inline)) void UmaVidaGravarCorpo(const int *restrict tabulIn, int *restrict tabulOut, int tam, int ld, Gravador *grav) {
+    uint8_t *mudou = grav->linha_mudou;
+    int i, j, vizviv, candidata, acima = 0;
+
+    for (i = 1; i <= tam; i++) {
+        for (j = 1; j <= tam; j++) {
+            vizviv = tabulIn[ind2d(i - 1, j - 1)] + tabulIn[ind2d(i - 1, j)] +
+                     tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
+                     tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
+                     tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
+
+            tabulOut[ind2d(i, j)] = (vizviv == 3) | (tabulIn[ind2d(i, j)] & (vizviv == 2));
+        }
+
+        // acima guarda o valor de mudou[i - 1] da geracao anterior
+        candidata = acima | mudou[i] | mudou[i + 1];
+        acima = mudou[i];
+        mudou[i] = candidata && memcmp(&tabulIn[ind2d(i, 1)], &tabulOut[ind2d(i, 1)], tam * sizeof(int)) != 0;
+        if (mudou[i]) {
+            EmitirLinha(grav, i, &tabulIn[ind2d(i, 1)], &tabulOut[ind2d(i, 1)], tam);
+        }
+    }
+}
+
+/* Corpo do kernel de somas de colunas: para cada linha i, soma[j] guarda
+   a soma vertical das 3 celulas da coluna j (linhas i-1, i, i+1), calculada
+   uma vez por coluna. A vizinhanca de (i, j) e a janela de 3 colunas
+   soma[j-1] + soma[j] + soma[j+1] menos a propria celula: cada celula custa
+   uma soma de coluna nova e 2 adicoes da janela, em vez de 8 leituras. */
+static inline __attribute__((always_inline)) void UmaVidaColunasCorpo(const int *restrict tabulIn, int *restrict tabulOut, int tam, int ld) {
+    int i, j, vizviv;
+    int soma[tam + 2];
+
+    for (i = 1; i <= tam; i++) {
+        for (j = 0; j <= tam + 1; j++) {
+            soma[j] = tabulIn[ind2d(i - 1, j)] + tabulIn[ind2d(i, j)] + tabulIn[ind2d(i + 1, j)];
+        }
+        for (j = 1; j <= tam; j++) {
+            vizviv = soma[j - 1] + soma[j] + soma[j + 1] - tabulIn[ind2d(i, j)];
+            tabulOut[ind2d(i, j)] = (vizviv == 3) | (tabulIn[ind2d(i, j)] & (vizviv == 2));
+        }
+    }
+}
+
+/* Kernels genericos para tamanhos sem versao especializada */
+static void UmaVidaGenerica(const int *restrict tabulIn, int *restrict tabulOut, int tam) {
+    UmaVidaCorpo(tabulIn, tabulOut, tam, Largura(tam));
+}
+
+static void UmaVidaGravarGenerica(const int *restrict tabulIn, int *restrict tabulOut, int tam, Gravador *grav) {
+    UmaVidaGravarCorpo(tabulIn, tabulOut, tam, Largura(tam), grav);
+}
+
+static void UmaVidaColunasGenerica(const int *restrict tabulIn, int *restrict tabulOut, int tam) {
+    UmaVidaColunasCorpo(tabulIn, tabulOut, tam, Largura(tam));
+}
+
+/* Versoes especializadas em tempo de compilacao para os tamanhos usuais */
+#define UMAVIDA_ESPECIALIZADA(T)                                                                         \
+    static void UmaVida_##T(const int *restrict tabulIn, int *restrict tabulOut) {                       \
+        UmaVidaCorpo(tabulIn, tabulOut, T, Largura(T));                                                  \
+    }                                                                                                    \
+    static void UmaVidaGravar_##T(const int *restrict tabulIn, int *restrict tabulOut, Gravador *grav) { \
+        UmaVidaGravarCorpo(tabulIn, tabulOut, T, Largura(T), grav);                                      \
+    }                                                                                                    \
+    static void UmaVidaColunas_##T(const int *restrict tabulIn, int *restrict tabulOut) {                \
+        UmaVidaColunasCorpo(tabulIn, tabulOut, T, Largura(T));                                           \
+    }
+
+UMAVIDA_ESPECIALIZADA(8)
+UMAVIDA_ESPECIALIZADA(16)
+UMAVIDA_ESPECIALIZADA(32)
+UMAVIDA_ESPECIALIZADA(64)
+UMAVIDA_ESPECIALIZADA(128)
+UMAVIDA_ESPECIALIZADA(256)
+UMAVIDA_ESPECIALIZADA(512)
+UMAVIDA_ESPECIALIZADA(1024)
+UMAVIDA_ESPECIALIZADA(2048)
+UMAVIDA_ESPECIALIZADA(4096)
+
+void UmaVida(int *tabulIn, int *tabulOut, int tam) {
+    switch (tam) {
+    case 8: UmaVida_8(tabulIn, tabulOut); break;
+    case 16: UmaVida_16(tabulIn, tabulOut); break;
+    case 32: UmaVida_32(tabulIn, tabulOut); break;
+    case 64: UmaVida_64(tabulIn, tabulOut); break;
+    case 128: UmaVida_128(tabulIn, tabulOut); break;
+    case 256: UmaVida_256(tabulIn, tabulOut); break;
+    case 512: UmaVida_512(tabulIn, tabulOut); break;
+    case 1024: UmaVida_1024(tabulIn, tabulOut); break;
+    case 2048: UmaVida_2048(tabulIn, tabulOut); break;
+    case 4096: UmaVida_4096(tabulIn, tabulOut); break;
+    default: UmaVidaGenerica(tabulIn, tabulOut, tam); break;
+    }
+}
+
+void UmaVidaColunas(int *tabulIn, int *tabulOut, int tam) {
+    switch (tam) {
+    case 8: UmaVidaColunas_8(tabulIn, tabulOut); break;
+    case 16: UmaVidaColunas_16(tabulIn, tabulOut); break;
+    case 32: UmaVidaColunas_32(tabulIn, tabulOut); break;
+    case 64: UmaVidaColunas_64(tabulIn, tabulOut); break;
+    case 128: UmaVidaColunas_128(tabulIn, tabulOut); break;
+    case 256: UmaVidaColunas_256(tabulIn, tabulOut); break;
+    case 512: UmaVidaColunas_512(tabulIn, tabulOut); break;
+    case 1024: UmaVidaColunas_1024(tabulIn, tabulOut); break;
+    case 2048: UmaVidaColunas_2048(tabulIn, tabulOut); break;
+    case 4096: UmaVidaColunas_4096(tabulIn, tabulOut); break;
+    default: UmaVidaColunasGenerica(tabulIn, tabulOut, tam); break;
+    }
+}
+
+/* Uma geracao com gravacao: quadro delta com as linhas alteradas e, a cada
+   intervalo, um quadro chave com o tabuleiro resultante */
+int UmaVidaGravar(int *tabulIn, int *tabulOut, int tam, Gravador *grav) {
+    IniciarQuadro(grav, QUADRO_DELTA, ++grav->geracao);
+    switch (tam) {
+    case 8: UmaVidaGravar_8(tabulIn, tabulOut, grav); break;
+    case 16: UmaVidaGravar_16(tabulIn, tabulOut, grav); break;
+    case 32: UmaVidaGravar_32(tabulIn, tabulOut, grav); break;
+    case 64: UmaVidaGravar_64(tabulIn, tabulOut, grav); break;
+    case 128: UmaVidaGravar_128(tabulIn, tabulOut, grav); break;
+    case 256: UmaVidaGravar_256(tabulIn, tabulOut, grav); break;
+    case 512: UmaVidaGravar_512(tabulIn, tabulOut, grav); break;
+    case 1024: UmaVidaGravar_1024(tabulIn, tabulOut, grav); break;
+    case 2048: UmaVidaGravar_2048(tabulIn, tabulOut, grav); break;
+    case 4096: UmaVidaGravar_4096(tabulIn, tabulOut, grav); break;
+    default: UmaVidaGravarGenerica(tabulIn, tabulOut, tam, grav); break;
+    }
+    if (FecharQuadro(grav) != 0) {
+        return -1;
+    }
+    return grav->geracao % grav->intervalo == 0 ? GravarChave(grav, tabulOut) : 0;
+}
+
+/* Layout em blocos (blocos.h): conversao de/para o layout linha a linha
+   (E/S e Correto) e uma geracao percorrendo os blocos em ordem Z */
+void ParaBlocos(int *tabul, TabulBlocos *tb) {
+    int k, ld = Largura(tb->tam);
+
+    for (k = 0; k < tb->nb * tb->nb; k++) {
+        ParaBloco(tabul, ld, tb, k);
+    }
+}
+
+void DeBlocos(TabulBlocos *tb, int *tabul) {
+    int k, ld = Largura(tb->tam);
+
+    for (k = 0; k < tb->nb * tb->nb; k++) {
+        DeBloco(tb, k, tabul, ld);
+    }
+}
+
+/* Atualiza as bordas da entrada e percorre os blocos em ordem Z */
+void UmaVidaBlocos(TabulBlocos *in, TabulBlocos *out) {
+    int k, n = in->nb * in->nb;
+
+    for (k = 0; k < n; k++) {
+        AtualizarBordas(in, k);
+    }
+    for (k = 0; k < n; k++) {
+        UmaVidaBloco(in, out, k);
+    }
+}
+
 void InitTabul(int *tabulIn, int *tabulOut, int tam) {
-    int ij;
+    int ij, ld = Largura(tam);
 
-    for (ij = 0; ij < (tam + 2) * (tam + 2); ij++) {
+    for (ij = 0; ij < (tam + 2) * ld; ij++) {
         tabulIn[ij] = 0;
         tabulOut[ij] = 0;
     }
@@ -55,10 +403,10 @@ void InitTabul(int *tabulIn, int *tabulOut, int tam) {
 }
 
 int Correto(int *tabul, int tam) {
-    int ij, cnt;
+    int ij, cnt, ld = Largura(tam);
 
     cnt = 0;
-    for (ij = 0; ij < (tam + 2) * (tam + 2); ij++) {
+    for (ij = 0; ij < (tam + 2) * ld; ij++) {
         cnt = cnt + tabul[ij];
     }
     return (cnt == 5 && tabul[ind2d(tam - 2, tam - 1)] &&
@@ -66,28 +414,120 @@ int Correto(int *tabul, int tam) {
             tabul[ind2d(tam, tam - 1)] && tabul[ind2d(tam, tam)]);
 }
 
-int main(void) {
-    int pow;
+int main(int argc, char **argv) {
+    int k, ntam, opt;
     int i, tam, *tabulIn, *tabulOut;
     double t0, t1, t2, t3;
+    int kernel = KERNEL_CLASSICO, bloco = BLOCO_PADRAO;
+    int intervalo = INTERVALO_CHAVE, erro_grav;
+    char *prefixo_grav = NULL, caminho_grav[512];
+    TabulBlocos blA, blB;
+    Gravador grav;
 
-    for (pow = POWMIN; pow <= POWMAX; pow++) {
-        tam = 1 << pow;
+    // -k classico|morton|colunas: kernel; -b <lado>: lado do bloco do layout morton
+    // -g <prefixo>: grava o fluxo de geracoes em <prefixo>_<tam>.jvd (kernel classico)
+    // -i <geracoes>: intervalo entre quadros chave do fluxo
+    while ((opt = getopt(argc, argv, "k:b:g:i:")) != -1) {
+        if (opt == 'k' && strcmp(optarg, "classico") == 0) {
+            kernel = KERNEL_CLASSICO;
+        }
+        else if (opt == 'k' && strcmp(optarg, "morton") == 0) {
+            kernel = KERNEL_MORTON;
+        }
+        else if (opt == 'k' && strcmp(optarg, "colunas") == 0) {
+            kernel = KERNEL_COLUNAS;
+        }
+        else if (opt == 'b' && atoi(optarg) > 0) {
+            bloco = atoi(optarg);
+        }
+        else if (opt == 'g') {
+            prefixo_grav = optarg;
+        }
+        else if (opt == 'i' && atoi(optarg) > 0) {
+            intervalo = atoi(optarg);
+        }
+        else {
+            printf("Uso: %s [-k classico|morton|colunas] [-b lado_bloco] [-g prefixo_fluxo] [-i intervalo_chave] [tam ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (prefixo_grav && kernel != KERNEL_CLASSICO) {
+        printf("A gravacao (-g) usa o kernel classico\n");
+        return 1;
+    }
+
+    // Tamanhos pela linha de comando (ex.: ./jogodavida 1000 2000) ou a
+    // varredura padrao 2^POWMIN..2^POWMAX
+    ntam = optind < argc ? argc - optind : POWMAX - POWMIN + 1;
+
+    for (k = 0; k < ntam; k++) {
+        tam = optind < argc ? atoi(argv[optind + k]) : 1 << (POWMIN + k);
+        if (tam < 4) {
+            printf("Tamanho invalido: %s (minimo 4)\n", argv[optind + k]);
+            return 1;
+        }
         t0 = wall_time();
-        tabulIn = (int *)malloc((tam + 2) * (tam + 2) * sizeof(int));
-        tabulOut = (int *)malloc((tam + 2) * (tam + 2) * sizeof(int));
+        tabulIn = (int *)malloc((tam + 2) * Largura(tam) * sizeof(int));
+        tabulOut = (int *)malloc((tam + 2) * Largura(tam) * sizeof(int));
 
         InitTabul(tabulIn, tabulOut, tam);
 
+        if (kernel == KERNEL_MORTON) {
+            if (CriarBlocos(&blA, tam, bloco) != 0 || CriarBlocos(&blB, tam, bloco) != 0) {
+                printf("Erro de alocacao de memoria\n");
+                return 1;
+            }
+            ParaBlocos(tabulIn, &blA);
+        }
+
+        if (prefixo_grav) {
+            snprintf(caminho_grav, sizeof(caminho_grav), "%s_%d.jvd", prefixo_grav, tam);
+            if (AbrirGravacao(&grav, caminho_grav, tam, intervalo, tabulIn) != 0) {
+                printf("Erro ao abrir o fluxo %s\n", caminho_grav);
+                return 1;
+            }
+        }
+
         t1 = wall_time();
 
-        for (i = 0; i < 2 * (tam - 3); i++) {
-            UmaVida(tabulIn, tabulOut, tam);
-            UmaVida(tabulOut, tabulIn, tam);
+        if (kernel == KERNEL_MORTON) {
+            for (i = 0; i < 2 * (tam - 3); i++) {
+                UmaVidaBlocos(&blA, &blB);
+                UmaVidaBlocos(&blB, &blA);
+            }
+        }
+        else if (prefixo_grav) {
+            erro_grav = 0;
+            for (i = 0; i < 2 * (tam - 3) && !erro_grav; i++) {
+                erro_grav = UmaVidaGravar(tabulIn, tabulOut, tam, &grav) ||
+                            UmaVidaGravar(tabulOut, tabulIn, tam, &grav);
+            }
+            if (FecharGravacao(&grav) != 0 || erro_grav) {
+                printf("Erro ao gravar o fluxo %s\n", caminho_grav);
+                return 1;
+            }
+        }
+        else if (kernel == KERNEL_COLUNAS) {
+            for (i = 0; i < 2 * (tam - 3); i++) {
+                UmaVidaColunas(tabulIn, tabulOut, tam);
+                UmaVidaColunas(tabulOut, tabulIn, tam);
+            }
+        }
+        else {
+            for (i = 0; i < 2 * (tam - 3); i++) {
+                UmaVida(tabulIn, tabulOut, tam);
+                UmaVida(tabulOut, tabulIn, tam);
+            }
         }
 
         t2 = wall_time();
 
+        if (kernel == KERNEL_MORTON) {
+            DeBlocos(&blA, tabulIn);
+            LiberarBlocos(&blA);
+            LiberarBlocos(&blB);
+        }
+
         if (Correto(tabulIn, tam)) {
             printf("**RESULTADO CORRETO**\n");
         }
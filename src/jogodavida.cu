@@ -115,8 +115,8 @@ int Correto(int* tabul, int tam){
       tabul[ind2d(tam  ,tam-1)] && tabul[ind2d(tam  ,tam  )]);
 }
 
-int main(void) {
-  int pow;
+int main(int argc, char **argv) {
+  int k, ntam;
   int i, tam, *h_tabulIn, *h_tabulOut;  // Host arrays
   int *d_tabulIn, *d_tabulOut;          // Device arrays
   double t0, t1, t2, t3;
@@ -136,9 +136,16 @@ int main(void) {
   printf("Compute Capability: %d.%d\n", deviceProp.major, deviceProp.minor);
   printf("Memoria Global: %lu bytes\n", deviceProp.totalGlobalMem);
 
+  // Tamanhos pela linha de comando ou a varredura padrao 2^POWMIN..2^POWMAX
+  ntam = argc > 1 ? argc-1 : POWMAX-POWMIN+1;
+
   // Loop para todos os tamanhos do tabuleiro
-  for (pow=POWMIN; pow<=POWMAX; pow++) {
-    tam = 1 << pow;
+  for (k=0; k<ntam; k++) {
+    tam = argc > 1 ? atoi(argv[k+1]) : 1 << (POWMIN+k);
+    if (tam < 4) {
+      printf("Tamanho invalido: %s (minimo 4)\n", argv[k+1]);
+      return 1;
+    }
     int total_size = (tam+2)*(tam+2)*sizeof(int);
     
     printf("\n--- Processando tabuleiro %dx%d ---\n", tam, tam);
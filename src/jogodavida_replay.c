@@ -0,0 +1,304 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#define ind2d(i, j) (i) * (tam + 2) + j
+
+// Formato do fluxo gravado por jogodavida -g (ver Gravador em jogodavida.c)
+#define FLUXO_MAGICO 0x5344564au // "JVDS"
+#define FLUXO_FIM 0x4944564au    // "JVDI"
+#define FLUXO_VERSAO 1
+#define QUADRO_DELTA 1
+#define QUADRO_CHAVE 2
+#define QUADRO_INDICE 3
+#define FIM_LINHAS 0xffffffffu
+
+typedef struct {
+    FILE *f;
+    int tam, intervalo;
+    int nchaves;
+    uint32_t *chave_ger;
+    uint64_t *chave_off;
+    uint64_t off_indice; // fim dos quadros
+    uint32_t *quadro;    // palavras do ultimo quadro lido
+    size_t cap;
+} Fluxo;
+
+void DumpTabul(int *tabul, int tam, int first, int last, char *msg) {
+    int i, ij;
+
+    printf("%s; Dump posicoes [%d:%d, %d:%d] de tabuleiro %d x %d\n",
+           msg, first, last, first, last, tam, tam);
+    for (i = first; i <= last; i++)
+        printf("=");
+    printf("=\n");
+    for (i = ind2d(first, 0); i <= ind2d(last, 0); i += ind2d(1, 0)) {
+        for (ij = i + first; ij <= i + last; ij++)
+            printf("%c", tabul[ij] ? 'X' : '.');
+        printf("\n");
+    }
+    for (i = first; i <= last; i++)
+        printf("=");
+    printf("=\n");
+}
+
+static int LerPalavras(FILE *f, uint32_t *v, size_t n) {
+    return fread(v, sizeof(uint32_t), n, f) == n ? 0 : -1;
+}
+
+/* Le cabecalho, rodape e indice de chaves */
+int AbrirFluxo(Fluxo *fl, const char *caminho) {
+    uint32_t cab[4], fim[3], ind[2], e[3];
+    int k;
+
+    memset(fl, 0, sizeof(*fl));
+    fl->f = fopen(caminho, "rb");
+    if (!fl->f || LerPalavras(fl->f, cab, 4) != 0 || cab[0] != FLUXO_MAGICO || cab[1] != FLUXO_VERSAO) {
+        return -1;
+    }
+    fl->tam = cab[2];
+    fl->intervalo = cab[3];
+
+    if (fseek(fl->f, -(long)sizeof(fim), SEEK_END) != 0 || LerPalavras(fl->f, fim, 3) != 0 ||
+        fim[2] != FLUXO_FIM) {
+        return -1;
+    }
+    fl->off_indice = fim[0] | (uint64_t)fim[1] << 32;
+    if (fseek(fl->f, (long)fl->off_indice, SEEK_SET) != 0 || LerPalavras(fl->f, ind, 2) != 0 ||
+        ind[0] != QUADRO_INDICE) {
+        return -1;
+    }
+    fl->nchaves = ind[1];
+    fl->chave_ger = (uint32_t *)malloc((fl->nchaves + 1) * sizeof(uint32_t));
+    fl->chave_off = (uint64_t *)malloc((fl->nchaves + 1) * sizeof(uint64_t));
+    if (!fl->chave_ger || !fl->chave_off) {
+        return -1;
+    }
+    for (k = 0; k < fl->nchaves; k++) {
+        if (LerPalavras(fl->f, e, 3) != 0) {
+            return -1;
+        }
+        fl->chave_ger[k] = e[0];
+        fl->chave_off[k] = e[1] | (uint64_t)e[2] << 32;
+    }
+    return fl->nchaves > 0 ? 0 : -1;
+}
+
+void FecharFluxo(Fluxo *fl) {
+    if (fl->f) {
+        fclose(fl->f);
+    }
+    free(fl->chave_ger);
+    free(fl->chave_off);
+    free(fl->quadro);
+}
+
+/* Le o proximo quadro; retorna o tipo (0 no fim dos quadros, -1 em erro) */
+int LerQuadro(Fluxo *fl, uint32_t *geracao, size_t *n) {
+    uint32_t q[3];
+
+    if ((uint64_t)ftell(fl->f) >= fl->off_indice) {
+        return 0;
+    }
+    if (LerPalavras(fl->f, q, 3) != 0) {
+        return -1;
+    }
+    if (q[2] > fl->cap) {
+        fl->cap = q[2];
+        fl->quadro = (uint32_t *)realloc(fl->quadro, fl->cap * sizeof(uint32_t));
+        if (!fl->quadro) {
+            return -1;
+        }
+    }
+    if (LerPalavras(fl->f, fl->quadro, q[2]) != 0) {
+        return -1;
+    }
+    *geracao = q[1];
+    *n = q[2];
+    return (int)q[0];
+}
+
+/* Aplica os runs do quadro: inverte (delta) ou marca como vivas (chave) */
+int AplicarQuadro(Fluxo *fl, int *tabul, size_t n, int tipo) {
+    int tam = fl->tam;
+    size_t p = 0;
+    uint32_t i, r, nruns, j, c, len;
+
+    while (p < n && fl->quadro[p] != FIM_LINHAS) {
+        if (p + 2 > n) {
+            return -1;
+        }
+        i = fl->quadro[p++];
+        nruns = fl->quadro[p++];
+        if (i < 1 || i > (uint32_t)tam || p + 2 * (size_t)nruns > n) {
+            return -1;
+        }
+        for (r = 0; r < nruns; r++) {
+            j = fl->quadro[p++];
+            len = fl->quadro[p++];
+            if (j < 1 || len > (uint32_t)tam || j + len - 1 > (uint32_t)tam) {
+                return -1;
+            }
+            for (c = j; c < j + len; c++) {
+                tabul[ind2d(i, c)] = tipo == QUADRO_CHAVE ? 1 : !tabul[ind2d(i, c)];
+            }
+        }
+    }
+    return 0;
+}
+
+/* Posiciona o tabuleiro na geracao pedida: carrega a ultima chave <= geracao
+   e aplica os deltas seguintes. Retorna a geracao alcancada (menor que a
+   pedida se o fluxo terminar antes) ou -1 em erro. */
+long Buscar(Fluxo *fl, int *tabul, long geracao) {
+    uint32_t g;
+    size_t n;
+    int k, tipo, tam = fl->tam;
+    long atual;
+
+    for (k = 0; k + 1 < fl->nchaves && fl->chave_ger[k + 1] <= geracao; k++)
+        ;
+    if (fseek(fl->f, (long)fl->chave_off[k], SEEK_SET) != 0 ||
+        LerQuadro(fl, &g, &n) != QUADRO_CHAVE) {
+        return -1;
+    }
+    memset(tabul, 0, (tam + 2) * (tam + 2) * sizeof(int));
+    if (AplicarQuadro(fl, tabul, n, QUADRO_CHAVE) != 0) {
+        return -1;
+    }
+    atual = g;
+
+    while (atual < geracao) {
+        tipo = LerQuadro(fl, &g, &n);
+        if (tipo == 0) {
+            break;
+        }
+        if (tipo < 0) {
+            return -1;
+        }
+        if (tipo == QUADRO_DELTA) {
+            if (g != atual + 1 || AplicarQuadro(fl, tabul, n, QUADRO_DELTA) != 0) {
+                return -1;
+            }
+            atual = g;
+        }
+    }
+    return atual;
+}
+
+int ContaVivas(int *tabul, int tam) {
+    int i, j, cnt = 0;
+
+    for (i = 1; i <= tam; i++) {
+        for (j = 1; j <= tam; j++) {
+            cnt += tabul[ind2d(i, j)];
+        }
+    }
+    return cnt;
+}
+
+/* Reproduz o fluxo inteiro a partir da chave 0 e compara com cada chave */
+int Verificar(Fluxo *fl, int *tabul, int *chave) {
+    uint32_t g;
+    size_t n;
+    int tipo, tam = fl->tam, nchaves = 0;
+    long atual;
+
+    if (Buscar(fl, tabul, 0) != 0) {
+        return -1;
+    }
+    atual = 0;
+    while ((tipo = LerQuadro(fl, &g, &n)) > 0) {
+        if (tipo == QUADRO_DELTA) {
+            if (g != atual + 1 || AplicarQuadro(fl, tabul, n, QUADRO_DELTA) != 0) {
+                return -1;
+            }
+            atual = g;
+        }
+        else if (tipo == QUADRO_CHAVE) {
+            memset(chave, 0, (tam + 2) * (tam + 2) * sizeof(int));
+            if (g != atual || AplicarQuadro(fl, chave, n, QUADRO_CHAVE) != 0 ||
+                memcmp(tabul, chave, (tam + 2) * (tam + 2) * sizeof(int)) != 0) {
+                printf("Divergencia na chave da geracao %u\n", g);
+                return -1;
+            }
+            nchaves++;
+        }
+    }
+    if (tipo < 0) {
+        return -1;
+    }
+    printf("Verificacao: %ld geracoes, %d chaves conferidas\n", atual, nchaves);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Fluxo fl;
+    int *tabul, *chave, opt, dump = 0, verificar = 0;
+    long geracao = -1, alcancada;
+    char msg[128];
+
+    // -d: imprime o tabuleiro; -c: confere os deltas contra as chaves
+    while ((opt = getopt(argc, argv, "dc")) != -1) {
+        if (opt == 'd') {
+            dump = 1;
+        }
+        else if (opt == 'c') {
+            verificar = 1;
+        }
+        else {
+            printf("Uso: %s [-d] [-c] arquivo.jvd [geracao]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        printf("Uso: %s [-d] [-c] arquivo.jvd [geracao]\n", argv[0]);
+        return 1;
+    }
+    if (optind + 1 < argc) {
+        geracao = atol(argv[optind + 1]);
+    }
+
+    if (AbrirFluxo(&fl, argv[optind]) != 0) {
+        printf("Fluxo invalido: %s\n", argv[optind]);
+        FecharFluxo(&fl);
+        return 1;
+    }
+    printf("Fluxo %s: tam=%d, intervalo=%d, chaves=%d (ultima na geracao %u), %llu bytes\n",
+           argv[optind], fl.tam, fl.intervalo, fl.nchaves, fl.chave_ger[fl.nchaves - 1],
+           (unsigned long long)fl.off_indice);
+
+    tabul = (int *)malloc((fl.tam + 2) * (fl.tam + 2) * sizeof(int));
+    chave = (int *)malloc((fl.tam + 2) * (fl.tam + 2) * sizeof(int));
+    if (!tabul || !chave) {
+        printf("Erro de alocacao de memoria\n");
+        return 1;
+    }
+
+    if (verificar && Verificar(&fl, tabul, chave) != 0) {
+        printf("**FLUXO INCONSISTENTE**\n");
+        return 1;
+    }
+
+    if (geracao >= 0) {
+        alcancada = Buscar(&fl, tabul, geracao);
+        if (alcancada < 0) {
+            printf("Erro de leitura do fluxo\n");
+            return 1;
+        }
+        if (alcancada < geracao) {
+            printf("Fluxo termina na geracao %ld\n", alcancada);
+        }
+        printf("geracao=%ld; vivas=%d\n", alcancada, ContaVivas(tabul, fl.tam));
+        if (dump) {
+            snprintf(msg, sizeof(msg), "Geracao %ld", alcancada);
+            DumpTabul(tabul, fl.tam, 1, fl.tam, msg);
+        }
+    }
+
+    free(tabul);
+    free(chave);
+    FecharFluxo(&fl);
+    return 0;
+}
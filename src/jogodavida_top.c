@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "telemetria.h"
+
+static const char *NomesFase[] = {"iniciando", "init", "comp", "fim", "terminado"};
+
+double wall_time(void) {
+    struct timeval tv;
+    struct timezone tz;
+
+    gettimeofday(&tv, &tz);
+    return (tv.tv_sec + tv.tv_usec / 1000000.0);
+}
+
+/* Imprime uma amostra; so leituras relaxadas, nenhuma escrita no bloco */
+void Amostra(Telemetria *t, int limpar) {
+    int k, fase = atomic_load_explicit(&t->fase, RELAXADO);
+    int64_t ger = atomic_load_explicit(&t->geracao, RELAXADO);
+    int64_t total = atomic_load_explicit(&t->total_geracoes, RELAXADO);
+    int64_t pop = atomic_load_explicit(&t->populacao, RELAXADO);
+    double decorrido = wall_time() - atomic_load_explicit(&t->inicio_fase, RELAXADO);
+
+    if (pop < 0) {
+        for (k = 0, pop = 0; k < t->ntrab; k++) {
+            pop += atomic_load_explicit(&t->trab[k].populacao, RELAXADO);
+        }
+    }
+    if (limpar) {
+        printf("\033[H\033[2J");
+    }
+    printf("%s pid=%d tam=%d fase=%s (%.1fs) geracao=%lld/%lld (%.1f%%) ger/s=%.1f populacao=%lld\n",
+           t->programa, t->pid, atomic_load_explicit(&t->tam, RELAXADO),
+           NomesFase[fase >= TELEM_INICIANDO && fase <= TELEM_TERMINADO ? fase : 0], decorrido,
+           (long long)ger, (long long)total, total > 0 ? 100.0 * ger / total : 0.0,
+           atomic_load_explicit(&t->ger_por_seg, RELAXADO), (long long)pop);
+    printf("  tempos: init=%7.7f, comp=%7.7f, fim=%7.7f\n", atomic_load_explicit(&t->t_init, RELAXADO),
+           atomic_load_explicit(&t->t_comp, RELAXADO), atomic_load_explicit(&t->t_fim, RELAXADO));
+    for (k = 0; k < t->ntrab; k++) {
+        printf("  %s %3d: geracao=%lld itens=%lld populacao=%lld", strcmp(t->programa, "mpi") == 0 ? "rank" : "thread", k,
+               (long long)atomic_load_explicit(&t->trab[k].geracao, RELAXADO),
+               (long long)atomic_load_explicit(&t->trab[k].itens, RELAXADO),
+               (long long)atomic_load_explicit(&t->trab[k].populacao, RELAXADO));
+        if (strcmp(t->programa, "mpi") == 0) {
+            printf(" comm=%7.7f", atomic_load_explicit(&t->trab[k].t_comm, RELAXADO));
+        }
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    Telemetria *t;
+    int opt, intervalo_ms = 500, amostras = -1, batch = 0, n;
+
+    // -i <ms>: intervalo entre amostras; -n <amostras>; -b: sem limpar a tela
+    while ((opt = getopt(argc, argv, "i:n:b")) != -1) {
+        if (opt == 'i' && atoi(optarg) > 0) {
+            intervalo_ms = atoi(optarg);
+        }
+        else if (opt == 'n' && atoi(optarg) > 0) {
+            amostras = atoi(optarg);
+        }
+        else if (opt == 'b') {
+            batch = 1;
+        }
+        else {
+            printf("Uso: %s [-i intervalo_ms] [-n amostras] [-b] nome\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        printf("Uso: %s [-i intervalo_ms] [-n amostras] [-b] nome\n", argv[0]);
+        return 1;
+    }
+
+    t = TelemAbrir(argv[optind], 0);
+    if (!t) {
+        printf("Telemetria %s nao encontrada (execute com -t %s)\n", argv[optind], argv[optind]);
+        return 1;
+    }
+
+    // Ate o fim da execucao, o fim do processo escritor ou -n amostras
+    for (n = 0; amostras < 0 || n < amostras; n++) {
+        Amostra(t, !batch);
+        if (atomic_load_explicit(&t->fase, RELAXADO) == TELEM_TERMINADO ||
+            (kill(t->pid, 0) != 0 && errno == ESRCH)) {
+            break;
+        }
+        usleep(intervalo_ms * 1000);
+    }
+
+    TelemFechar(t, argv[optind], 0);
+    return 0;
+}
@@ -3,10 +3,15 @@
 #include <sys/time.h>
 #include <mpi.h>
 #include <string.h>
+#include <unistd.h>
+#include "telemetria.h"
 
 #define ind2d(i, j) (i) * (tam + 2) + j
 #define POWMIN 3
 #define POWMAX 10
+#define LIMIAR_DESBALANCEAMENTO 1.10
+#define GANHO_MIN_REBALANCEAMENTO 0.05 // reducao minima do desbalanceamento para mover linhas
+#define PESO_MEDIA_CUSTO 0.3           // peso do ultimo periodo na media movel do custo por linha
 
 
 double wall_time(void) {
@@ -17,30 +22,311 @@ double wall_time(void) {
     return (tv.tv_sec + tv.tv_usec / 1000000.0);
 }
 
-void UmaVidaMPI_Distribuido(int *tabulIn, int *tabulOut, int tam, int start_row, int end_row) {
-    int i, j, vizviv;
+/* Retorna 1 se a linha i do tabuleiro nao tem celulas vivas */
+int LinhaVazia(int *tabul, int tam, int i) {
+    int j, acc = 0;
+
+    for (j = 1; j <= tam; j++) {
+        acc |= tabul[ind2d(i, j)];
+    }
+    return acc == 0;
+}
+
+/* Evolui as linhas [start_row, end_row]. Se custo != NULL (rebalanceamento,
+   -r), acumula o tempo gasto por linha e linhas cuja vizinhanca nao tem
+   celulas vivas nao passam pelo stencil: a linha de saida e apenas zerada.
+   Sem -r todas as linhas passam pelo stencil, o mesmo trabalho das versoes
+   sequencial e OpenMP. Com contar, retorna
+   as vivas calculadas (populacao da telemetria), somadas por linha fora do
+   laco interno; sem contar, retorna 0. */
+int UmaVidaMPI_Distribuido(int *tabulIn, int *tabulOut, int tam, int start_row, int end_row, double *custo, int contar) {
+    int i, j, vizviv, vivas = 0;
+    int vazia_acima, vazia, vazia_abaixo;
+    double t = 0.0;
+
+    vazia = custo && LinhaVazia(tabulIn, tam, start_row - 1);
+    vazia_abaixo = custo && LinhaVazia(tabulIn, tam, start_row);
 
     for (i = start_row; i <= end_row; i++) {
-        for (j = 1; j <= tam; j++) {
-            vizviv = tabulIn[ind2d(i - 1, j - 1)] + tabulIn[ind2d(i - 1, j)] +
-                     tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
-                     tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
-                     tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
+        if (custo) {
+            t = MPI_Wtime();
+        }
 
-            if (tabulIn[ind2d(i, j)] && vizviv < 2) {
-                tabulOut[ind2d(i, j)] = 0;
+        vazia_acima = vazia;
+        vazia = vazia_abaixo;
+        vazia_abaixo = custo && LinhaVazia(tabulIn, tam, i + 1);
+
+        if (vazia_acima && vazia && vazia_abaixo) {
+            memset(&tabulOut[ind2d(i, 1)], 0, tam * sizeof(int));
+        }
+        else {
+            for (j = 1; j <= tam; j++) {
+                vizviv = tabulIn[ind2d(i - 1, j - 1)] + tabulIn[ind2d(i - 1, j)] +
+                         tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
+                         tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
+                         tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
+
+                if (tabulIn[ind2d(i, j)] && vizviv < 2) {
+                    tabulOut[ind2d(i, j)] = 0;
+                }
+                else if (tabulIn[ind2d(i, j)] && vizviv > 3) {
+                    tabulOut[ind2d(i, j)] = 0;
+                }
+                else if (!tabulIn[ind2d(i, j)] && vizviv == 3) {
+                    tabulOut[ind2d(i, j)] = 1;
+                }
+                else {
+                    tabulOut[ind2d(i, j)] = tabulIn[ind2d(i, j)];
+                }
             }
-            else if (tabulIn[ind2d(i, j)] && vizviv > 3) {
-                tabulOut[ind2d(i, j)] = 0;
+            if (contar) {
+                for (j = 1; j <= tam; j++) {
+                    vivas += tabulOut[ind2d(i, j)];
+                }
             }
-            else if (!tabulIn[ind2d(i, j)] && vizviv == 3) {
-                tabulOut[ind2d(i, j)] = 1;
+        }
+
+        if (custo) {
+            custo[i] += MPI_Wtime() - t;
+        }
+    }
+    return vivas;
+}
+
+/* Particao uniforme das linhas [first_row, last_row] em nparts partes: a parte
+   r fica com [linha_ini[r], linha_ini[r + 1] - 1]; as primeiras partes recebem
+   uma linha a mais quando a divisao nao e exata */
+void ParticaoUniforme(int *linha_ini, int first_row, int last_row, int nparts) {
+    int r;
+    int rows = last_row - first_row + 1;
+    int rows_per_process = rows / nparts;
+    int remainder = rows % nparts;
+
+    for (r = 0; r <= nparts; r++) {
+        linha_ini[r] = first_row + r * rows_per_process + (r < remainder ? r : remainder);
+    }
+}
+
+/* Particao ponderada: divide as linhas [first_row, last_row] de forma que cada
+   parte receba aproximadamente o mesmo custo medido, com pelo menos uma linha */
+void ParticaoPorCusto(int *linha_ini, double *custo, int first_row, int last_row, int nparts) {
+    int i, r;
+    double total = 0.0, acc = 0.0;
+
+    for (i = first_row; i <= last_row; i++) {
+        total += custo[i];
+    }
+    if (last_row - first_row + 1 < nparts || total <= 0.0) {
+        ParticaoUniforme(linha_ini, first_row, last_row, nparts);
+        return;
+    }
+
+    linha_ini[0] = first_row;
+    r = 1;
+    for (i = first_row; i <= last_row && r < nparts; i++) {
+        acc += custo[i];
+        while (r < nparts && acc >= r * total / nparts) {
+            linha_ini[r++] = i + 1;
+        }
+    }
+    while (r <= nparts) {
+        linha_ini[r++] = last_row + 1;
+    }
+    linha_ini[nparts] = last_row + 1;
+
+    // Garantir ao menos uma linha por parte
+    for (r = 1; r < nparts; r++) {
+        if (linha_ini[r] < linha_ini[r - 1] + 1) {
+            linha_ini[r] = linha_ini[r - 1] + 1;
+        }
+    }
+    for (r = nparts - 1; r >= 1; r--) {
+        if (linha_ini[r] > linha_ini[r + 1] - 1) {
+            linha_ini[r] = linha_ini[r + 1] - 1;
+        }
+    }
+}
+
+/* Razao entre o maior custo por processo e o custo medio */
+double Desbalanceamento(int *linha_ini, double *custo, int size) {
+    int i, r;
+    double soma, maior = 0.0, total = 0.0;
+
+    for (r = 0; r < size; r++) {
+        soma = 0.0;
+        for (i = linha_ini[r]; i < linha_ini[r + 1]; i++) {
+            soma += custo[i];
+        }
+        if (soma > maior) {
+            maior = soma;
+        }
+        total += soma;
+    }
+    return total > 0.0 ? maior * size / total : 1.0;
+}
+
+/* Converte a particao em contagens/deslocamentos do Allgatherv e no range
+   de linhas da posicao pos deste processo */
+void AplicarParticao(int *linha_ini, int tam, int size, int pos, int *recvcounts, int *displs, int *local_start, int *local_end) {
+    int r;
+
+    for (r = 0; r < size; r++) {
+        recvcounts[r] = (linha_ini[r + 1] - linha_ini[r]) * (tam + 2);
+        displs[r] = linha_ini[r] * (tam + 2);
+    }
+
+    *local_start = linha_ini[pos];
+    *local_end = linha_ini[pos + 1] - 1;
+    if (*local_start > *local_end) {
+        *local_start = *local_end = 0; // Sem trabalho
+    }
+}
+
+/* Processos que compartilham memoria (mesmo no). As posicoes na particao de
+   linhas sao numeradas no a no, de forma que cada no recebe um bloco contiguo */
+typedef struct {
+    MPI_Comm comm;    // processos do no
+    MPI_Comm lideres; // um processo por no; MPI_COMM_NULL nos demais
+    int rank, size;   // rank e numero de processos no no
+    int indice, num;  // indice deste no e numero de nos
+    int *pos_ini;     // primeira posicao de cada no (num + 1 entradas)
+    MPI_Win win;      // janela com os dois tabuleiros do no
+} InfoNo;
+
+void CriarInfoNo(InfoNo *no, int rank) {
+    int k, *tamanhos;
+
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &no->comm);
+    MPI_Comm_rank(no->comm, &no->rank);
+    MPI_Comm_size(no->comm, &no->size);
+    MPI_Comm_split(MPI_COMM_WORLD, no->rank == 0 ? 0 : MPI_UNDEFINED, rank, &no->lideres);
+
+    if (no->lideres != MPI_COMM_NULL) {
+        MPI_Comm_rank(no->lideres, &no->indice);
+        MPI_Comm_size(no->lideres, &no->num);
+    }
+    MPI_Bcast(&no->indice, 1, MPI_INT, 0, no->comm);
+    MPI_Bcast(&no->num, 1, MPI_INT, 0, no->comm);
+
+    no->pos_ini = (int *)malloc((no->num + 1) * sizeof(int));
+    if (no->lideres != MPI_COMM_NULL) {
+        tamanhos = (int *)malloc(no->num * sizeof(int));
+        MPI_Allgather(&no->size, 1, MPI_INT, tamanhos, 1, MPI_INT, no->lideres);
+        no->pos_ini[0] = 0;
+        for (k = 0; k < no->num; k++) {
+            no->pos_ini[k + 1] = no->pos_ini[k] + tamanhos[k];
+        }
+        free(tamanhos);
+    }
+    MPI_Bcast(no->pos_ini, no->num + 1, MPI_INT, 0, no->comm);
+}
+
+void LiberarInfoNo(InfoNo *no) {
+    if (no->lideres != MPI_COMM_NULL) {
+        MPI_Comm_free(&no->lideres);
+    }
+    MPI_Comm_free(&no->comm);
+    free(no->pos_ini);
+}
+
+/* Aloca os dois tabuleiros do no numa janela MPI-3 compartilhada; cada
+   processo zera uma faixa de linhas (first touch local a cada processo) */
+void AlocarTabulNo(InfoNo *no, int tam, int **tabulA, int **tabulB) {
+    MPI_Aint bytes = no->rank == 0 ? 2 * (MPI_Aint)(tam + 2) * (tam + 2) * sizeof(int) : 0;
+    MPI_Aint tam_seg;
+    int disp_unit, *base;
+    int linhas = (tam + 2) / no->size + 1;
+    int ini = no->rank * linhas;
+    int fim = ini + linhas > tam + 2 ? tam + 2 : ini + linhas;
+
+    MPI_Win_allocate_shared(bytes, sizeof(int), MPI_INFO_NULL, no->comm, &base, &no->win);
+    MPI_Win_shared_query(no->win, 0, &tam_seg, &disp_unit, &base);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, no->win);
+
+    *tabulA = base;
+    *tabulB = base + (tam + 2) * (tam + 2);
+    if (ini < fim) {
+        memset(*tabulA + ind2d(ini, 0), 0, (fim - ini) * (tam + 2) * sizeof(int));
+        memset(*tabulB + ind2d(ini, 0), 0, (fim - ini) * (tam + 2) * sizeof(int));
+    }
+}
+
+void LiberarTabulNo(InfoNo *no) {
+    MPI_Win_unlock_all(no->win);
+    MPI_Win_free(&no->win);
+}
+
+/* Linhas [*first_row, *last_row] do bloco do no k (vazio se first > last) */
+void BlocoNo(InfoNo *no, int *linha_ini, int k, int *first_row, int *last_row) {
+    *first_row = linha_ini[no->pos_ini[k]];
+    *last_row = linha_ini[no->pos_ini[k + 1]] - 1;
+}
+
+/* Sincroniza o tabuleiro compartilhado apos uma meia-geracao. Dentro do no
+   basta sincronizar a janela; entre nos, os lideres trocam apenas as linhas
+   de fronteira do bloco com os nos vizinhos */
+void SincronizarNo(InfoNo *no, int *tabul, int tam, int *linha_ini) {
+    int first_row, last_row, ant_first, ant_last, prox_first, prox_last;
+    int ant = MPI_PROC_NULL, prox = MPI_PROC_NULL;
+
+    MPI_Win_sync(no->win);
+    MPI_Barrier(no->comm);
+
+    if (no->num > 1) {
+        BlocoNo(no, linha_ini, no->indice, &first_row, &last_row);
+
+        if (no->lideres != MPI_COMM_NULL && first_row <= last_row) {
+            // Blocos vazios so ocorrem no fim da particao
+            if (no->indice > 0) {
+                BlocoNo(no, linha_ini, no->indice - 1, &ant_first, &ant_last);
+                ant = ant_first <= ant_last ? no->indice - 1 : MPI_PROC_NULL;
             }
-            else {
-                tabulOut[ind2d(i, j)] = tabulIn[ind2d(i, j)];
+            if (no->indice < no->num - 1) {
+                BlocoNo(no, linha_ini, no->indice + 1, &prox_first, &prox_last);
+                prox = prox_first <= prox_last ? no->indice + 1 : MPI_PROC_NULL;
             }
+
+            MPI_Sendrecv(&tabul[ind2d(first_row, 0)], tam + 2, MPI_INT, ant, 0,
+                         &tabul[ind2d(last_row + 1, 0)], tam + 2, MPI_INT, prox, 0,
+                         no->lideres, MPI_STATUS_IGNORE);
+            MPI_Sendrecv(&tabul[ind2d(last_row, 0)], tam + 2, MPI_INT, prox, 1,
+                         &tabul[ind2d(first_row - 1, 0)], tam + 2, MPI_INT, ant, 1,
+                         no->lideres, MPI_STATUS_IGNORE);
         }
+
+        MPI_Win_sync(no->win);
+        MPI_Barrier(no->comm);
+    }
+
+    MPI_Win_sync(no->win);
+}
+
+/* Junta no processo 0 os blocos dos demais nos (usado apenas para o dump) */
+void ReunirTabulNo(InfoNo *no, int *tabul, int tam, int *linha_ini) {
+    int k, first_row, last_row;
+    int *counts, *desl;
+
+    if (no->num == 1 || no->lideres == MPI_COMM_NULL) {
+        return;
+    }
+
+    counts = (int *)malloc(no->num * sizeof(int));
+    desl = (int *)malloc(no->num * sizeof(int));
+    for (k = 0; k < no->num; k++) {
+        BlocoNo(no, linha_ini, k, &first_row, &last_row);
+        counts[k] = first_row <= last_row ? (last_row - first_row + 1) * (tam + 2) : 0;
+        desl[k] = first_row * (tam + 2);
+    }
+
+    if (no->indice == 0) {
+        MPI_Gatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, tabul, counts, desl, MPI_INT, 0, no->lideres);
+    }
+    else {
+        MPI_Gatherv(&tabul[desl[no->indice]], counts[no->indice], MPI_INT, tabul, counts, desl, MPI_INT, 0, no->lideres);
     }
+
+    free(counts);
+    free(desl);
 }
 
 /* Funcao para dump do tabuleiro - apenas o processo 0 imprime */
@@ -71,158 +357,346 @@ void DumpTabul(int *tabul, int tam, int first, int last, char *msg, int rank) {
     printf("=\n");
 }
 
-/* Inicializacao do tabuleiro */
-void InitTabul(int *tabulIn, int *tabulOut, int tam) {
-    int ij;
+/* Inicializacao local: cada processo marca apenas as celulas do veleiro que
+   caem nas linhas [first_row, last_row]. O tabuleiro vem zerado do calloc. */
+void InitTabul(int *tabulIn, int tam, int first_row, int last_row) {
+    int k;
+    // Configuracao inicial do veleiro no canto superior esquerdo
+    static const int veleiro[5][2] = {{1, 2}, {2, 3}, {3, 1}, {3, 2}, {3, 3}};
 
-    for (ij = 0; ij < (tam + 2) * (tam + 2); ij++) {
-        tabulIn[ij] = 0;
-        tabulOut[ij] = 0;
+    for (k = 0; k < 5; k++) {
+        if (veleiro[k][0] >= first_row && veleiro[k][0] <= last_row) {
+            tabulIn[ind2d(veleiro[k][0], veleiro[k][1])] = 1;
+        }
     }
-
-    // Configuracao inicial do veleiro no canto superior esquerdo
-    tabulIn[ind2d(1, 2)] = 1;
-    tabulIn[ind2d(2, 3)] = 1;
-    tabulIn[ind2d(3, 1)] = 1;
-    tabulIn[ind2d(3, 2)] = 1;
-    tabulIn[ind2d(3, 3)] = 1;
 }
 
-/* Verificacao se o resultado esta correto */
-int Correto(int *tabul, int tam) {
-    int ij, cnt;
+/* Verificacao distribuida: cada processo conta as celulas vivas e as posicoes
+   esperadas do veleiro nas suas linhas; o processo 0 recebe a soma via
+   MPI_Reduce. O retorno so e valido no processo 0. */
+int Correto(int *tabul, int tam, int first_row, int last_row) {
+    int i, j, k;
+    int local[2] = {0, 0}, total[2] = {0, 0};
+    int esperadas[5][2] = {{tam - 2, tam - 1}, {tam - 1, tam}, {tam, tam - 2},
+                           {tam, tam - 1}, {tam, tam}};
 
-    cnt = 0;
-    for (ij = 0; ij < (tam + 2) * (tam + 2); ij++) {
-        cnt = cnt + tabul[ij];
+    for (i = first_row; i <= last_row; i++) {
+        for (j = 1; j <= tam; j++) {
+            local[0] += tabul[ind2d(i, j)];
+        }
+    }
+    for (k = 0; k < 5; k++) {
+        if (esperadas[k][0] >= first_row && esperadas[k][0] <= last_row) {
+            local[1] += tabul[ind2d(esperadas[k][0], esperadas[k][1])] != 0;
+        }
     }
-    return (cnt == 5 && tabul[ind2d(tam - 2, tam - 1)] &&
-            tabul[ind2d(tam - 1, tam)] && tabul[ind2d(tam, tam - 2)] &&
-            tabul[ind2d(tam, tam - 1)] && tabul[ind2d(tam, tam)]);
+
+    MPI_Reduce(local, total, 2, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    return (total[0] == 5 && total[1] == 5);
 }
 
 int main(int argc, char **argv) {
     int rank, size;
-    int pow;
-    int i, tam, *tabulIn, *tabulOut, *temp_tabul;
+    int k, ntam;
+    int i, tam, *tabulIn, *temp_tabul;
     double t0, t1, t2, t3;
-    int local_start, local_end, rows_per_process;
-    int *recvcounts, *displs;
+    int local_start, local_end, pos;
+    int *recvcounts, *displs, *linha_ini, *linha_nova;
+    int opt, intervalo = 0, desde_rebalance, compartilhado = 0, vivas, mudou, periodos;
+    double *custo = NULL, *custo_total = NULL, *custo_medio = NULL;
+    double tc;
+    InfoNo no;
+    char *nome_telem = NULL;
+    Telemetria *telem = NULL;
 
     // Inicializacao MPI
     MPI_Init(&argc, &argv);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    // Alocar arrays para gather
-    recvcounts = (int *)malloc(size * sizeof(int));
-    displs = (int *)malloc(size * sizeof(int));
+    // -r <geracoes>: intervalo entre verificacoes de rebalanceamento (0 = desligado)
+    // -s: tabuleiro em memoria compartilhada MPI-3 entre processos do mesmo no
+    // -t <nome>: telemetria ao vivo em /dev/shm/jogodavida_<nome> (jogodavida_top)
+    while ((opt = getopt(argc, argv, "r:st:")) != -1) {
+        if (opt == 'r') {
+            intervalo = atoi(optarg);
+        }
+        else if (opt == 't') {
+            nome_telem = optarg;
+        }
+        else if (opt == 's') {
+            compartilhado = 1;
+        }
+        else {
+            if (rank == 0) {
+                printf("Uso: %s [-r intervalo_rebalanceamento] [-s] [-t nome_telemetria] [tam ...]\n", argv[0]);
+            }
+            MPI_Finalize();
+            return 1;
+        }
+    }
 
-    // Loop para todos os tamanhos do tabuleiro
-    for (pow = POWMIN; pow <= POWMAX; pow++) {
-        tam = 1 << pow;
+    // Posicao deste processo na particao de linhas: no modo compartilhado os
+    // processos sao ordenados no a no para que cada no tenha um bloco contiguo
+    pos = rank;
+    if (compartilhado) {
+        CriarInfoNo(&no, rank);
+        pos = no.pos_ini[no.indice] + no.rank;
+    }
+
+    if (rank == 0 && intervalo > 0) {
+        printf("Rebalanceamento dinamico a cada %d geracoes\n", intervalo);
+    }
+    if (rank == 0 && compartilhado) {
+        printf("Memoria compartilhada MPI-3: %d no(s); halos por mensagem apenas entre nos\n", no.num);
+    }
+
+    // Telemetria: o processo 0 cria o segmento e os demais o abrem; cada
+    // processo escreve apenas no seu slot. Processos em outros nos nao
+    // enxergam o segmento do no 0 e seguem sem telemetria.
+    if (nome_telem) {
+        int ok;
 
         if (rank == 0) {
-            t0 = wall_time();
+            telem = TelemCriar(nome_telem, "mpi", size);
+        }
+        ok = rank != 0 || telem != NULL;
+        MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (!ok) {
+            if (rank == 0) {
+                printf("Erro ao criar a telemetria %s\n", nome_telem);
+            }
+            MPI_Finalize();
+            return 1;
+        }
+        if (rank != 0) {
+            telem = TelemAbrir(nome_telem, 1);
+            if (!telem) {
+                printf("Processo %d: telemetria %s indisponivel neste no\n", rank, nome_telem);
+            }
         }
+    }
 
-        // Alocacao dos tabuleiros
-        tabulIn = (int *)calloc((tam + 2) * (tam + 2), sizeof(int));
-        tabulOut = (int *)calloc((tam + 2) * (tam + 2), sizeof(int));
-        temp_tabul = (int *)calloc((tam + 2) * (tam + 2), sizeof(int));
+    // Alocar arrays para gather e para a particao de linhas
+    recvcounts = (int *)malloc(size * sizeof(int));
+    displs = (int *)malloc(size * sizeof(int));
+    linha_ini = (int *)malloc((size + 1) * sizeof(int));
+    linha_nova = (int *)malloc((size + 1) * sizeof(int));
+
+    // Tamanhos apos as opcoes (ex.: mpirun -np 4 ./jogodavidampi 1000 2000) ou
+    // a varredura padrao 2^POWMIN..2^POWMAX
+    ntam = optind < argc ? argc - optind : POWMAX - POWMIN + 1;
 
-        if (!tabulIn || !tabulOut || !temp_tabul) {
+    // Loop para todos os tamanhos do tabuleiro
+    for (k = 0; k < ntam; k++) {
+        tam = optind < argc ? atoi(argv[optind + k]) : 1 << (POWMIN + k);
+        if (tam < 4) {
             if (rank == 0) {
-                printf("Erro de alocacao de memoria\n");
+                printf("Tamanho invalido: %s (minimo 4)\n", argv[optind + k]);
             }
             MPI_Abort(MPI_COMM_WORLD, 1);
         }
 
-        // Inicializar apenas no processo 0
+        if (telem) {
+            TelemZerarTrabalhador(telem, rank);
+        }
         if (rank == 0) {
-            InitTabul(tabulIn, tabulOut, tam);
+            t0 = wall_time();
+            if (telem) {
+                TelemTamanhoNovo(telem, tam, 4 * (tam - 3), t0);
+            }
         }
 
-        // Broadcast do tabuleiro inicial
-        MPI_Bcast(tabulIn, (tam + 2) * (tam + 2), MPI_INT, 0, MPI_COMM_WORLD);
-
-        // Mostrar estado inicial
-        DumpTabul(tabulIn, tam, 1, tam, "Estado Inicial - Veleiro no canto superior esquerdo", rank);
-
-        if (rank == 0) {
-            t1 = wall_time();
+        // Alocacao dos tabuleiros: janela compartilhada do no ou copia local
+        // completa (calloc ja entrega o tabuleiro zerado)
+        if (compartilhado) {
+            AlocarTabulNo(&no, tam, &tabulIn, &temp_tabul);
+        }
+        else {
+            tabulIn = (int *)calloc((tam + 2) * (tam + 2), sizeof(int));
+            temp_tabul = (int *)calloc((tam + 2) * (tam + 2), sizeof(int));
         }
 
-        // Calcular divisao de trabalho
-        rows_per_process = tam / size;
-        int remainder = tam % size;
+        // Custo medido por linha no periodo e, no processo 0, sua media movel
+        // exponencial por geracao, usada no rebalanceamento
+        if (intervalo > 0) {
+            custo = (double *)calloc(tam + 2, sizeof(double));
+            custo_total = (double *)calloc(tam + 2, sizeof(double));
+            custo_medio = (double *)calloc(tam + 2, sizeof(double));
+        }
 
-        // Configurar arrays para gather
-        for (i = 0; i < size; i++) {
-            if (i < remainder) {
-                recvcounts[i] = (rows_per_process + 1) * (tam + 2);
-                displs[i] = i * (rows_per_process + 1) * (tam + 2) + (tam + 2);
-            }
-            else {
-                recvcounts[i] = rows_per_process * (tam + 2);
-                displs[i] = (remainder * (rows_per_process + 1) + (i - remainder) * rows_per_process) * (tam + 2) + (tam + 2);
+        if (!tabulIn || !temp_tabul || (intervalo > 0 && (!custo || !custo_total || !custo_medio))) {
+            if (rank == 0) {
+                printf("Erro de alocacao de memoria\n");
             }
+            MPI_Abort(MPI_COMM_WORLD, 1);
         }
 
-        // Definir range de trabalho para este processo
-        if (rank < remainder) {
-            local_start = rank * (rows_per_process + 1) + 1;
-            local_end = local_start + rows_per_process;
-        }
-        else {
-            local_start = remainder * (rows_per_process + 1) + (rank - remainder) * rows_per_process + 1;
-            local_end = local_start + rows_per_process - 1;
+        // Divisao inicial de trabalho
+        ParticaoUniforme(linha_ini, 1, tam, size);
+        AplicarParticao(linha_ini, tam, size, pos, recvcounts, displs, &local_start, &local_end);
+
+        if (compartilhado) {
+            // Zeragem dos demais processos do no concluida antes da inicializacao
+            MPI_Win_sync(no.win);
+            MPI_Barrier(no.comm);
+            MPI_Win_sync(no.win);
         }
 
-        // Garantir limites validos
-        if (local_start > tam) {
-            local_start = tam + 1;
+        // Cada processo inicializa suas linhas e as linhas de borda que le
+        // na primeira geracao; o restante chega pelo primeiro Allgatherv
+        if (local_start > 0) {
+            InitTabul(tabulIn, tam, local_start - 1, local_end + 1);
         }
-        if (local_end > tam) {
-            local_end = tam;
+
+        if (compartilhado) {
+            MPI_Win_sync(no.win);
+            MPI_Barrier(no.comm);
+            MPI_Win_sync(no.win);
         }
-        if (local_start > local_end) {
-            local_start = local_end = 0; // Sem trabalho
+
+        // Mostrar estado inicial (visao local do processo 0, que contem o veleiro)
+        DumpTabul(tabulIn, tam, 1, tam, "Estado Inicial - Veleiro no canto superior esquerdo", rank);
+
+        if (rank == 0) {
+            t1 = wall_time();
+            if (telem) {
+                atomic_store_explicit(&telem->t_init, t1 - t0, RELAXADO);
+                TelemFase(telem, TELEM_COMP, t1);
+            }
         }
 
         // Loop principal de evolucao
+        desde_rebalance = 0;
+        periodos = 0;
         for (i = 0; i < 2 * (tam - 3); i++) {
             // Primeira evolucao: tabulIn -> temp_tabul
-            memcpy(temp_tabul, tabulIn, (tam + 2) * (tam + 2) * sizeof(int));
-
+            vivas = 0;
             if (local_start <= local_end && local_start > 0) {
-                UmaVidaMPI_Distribuido(tabulIn, temp_tabul, tam, local_start, local_end);
+                vivas = UmaVidaMPI_Distribuido(tabulIn, temp_tabul, tam, local_start, local_end, custo, telem != NULL);
+            }
+            if (telem) {
+                TelemTrabalho(telem, rank, local_start > 0 ? local_end - local_start + 1 : 0, vivas);
             }
 
-            // Gather dos resultados parciais
-            MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, temp_tabul, recvcounts, displs, MPI_INT, MPI_COMM_WORLD);
+            // Gather dos resultados parciais ou sincronizacao do no
+            tc = MPI_Wtime();
+            if (compartilhado) {
+                SincronizarNo(&no, temp_tabul, tam, linha_ini);
+            }
+            else {
+                MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, temp_tabul, recvcounts, displs, MPI_INT, MPI_COMM_WORLD);
+            }
+            if (telem) {
+                TelemComm(telem, rank, MPI_Wtime() - tc);
+            }
 
             // Segunda evolucao: temp_tabul -> tabulIn
-            memcpy(tabulIn, temp_tabul, (tam + 2) * (tam + 2) * sizeof(int));
-
+            vivas = 0;
             if (local_start <= local_end && local_start > 0) {
-                UmaVidaMPI_Distribuido(temp_tabul, tabulIn, tam, local_start, local_end);
+                vivas = UmaVidaMPI_Distribuido(temp_tabul, tabulIn, tam, local_start, local_end, custo, telem != NULL);
+            }
+            if (telem) {
+                TelemTrabalho(telem, rank, local_start > 0 ? local_end - local_start + 1 : 0, vivas);
+            }
+
+            // Gather dos resultados parciais ou sincronizacao do no
+            tc = MPI_Wtime();
+            if (compartilhado) {
+                SincronizarNo(&no, tabulIn, tam, linha_ini);
+            }
+            else {
+                MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, tabulIn, recvcounts, displs, MPI_INT, MPI_COMM_WORLD);
+            }
+            if (telem) {
+                TelemComm(telem, rank, MPI_Wtime() - tc);
+                if (rank == 0) {
+                    TelemGeracao(telem, 2 * (i + 1), wall_time());
+                }
             }
 
-            // Gather dos resultados parciais
-            MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, tabulIn, recvcounts, displs, MPI_INT, MPI_COMM_WORLD);
+            // Rebalanceamento: apos o Allgatherv todos os processos tem o
+            // tabuleiro completo e no modo compartilhado o tabuleiro do no e
+            // unico, entao mover linhas so muda a particao. No modo
+            // compartilhado os blocos de cada no ficam fixos. Uma amostra de
+            // MPI_Wtime por linha e ruidosa, entao a particao usa a media
+            // movel do custo e so muda se reduzir o desbalanceamento em
+            // pelo menos GANHO_MIN_REBALANCEAMENTO.
+            desde_rebalance += 2;
+            if (intervalo > 0 && desde_rebalance >= intervalo) {
+                MPI_Reduce(custo, custo_total, tam + 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+                mudou = 0;
+                if (rank == 0) {
+                    double peso = periodos++ > 0 ? PESO_MEDIA_CUSTO : 1.0;
+                    double desb, desb_nova;
+
+                    for (int l = 1; l <= tam; l++) {
+                        custo_medio[l] += peso * (custo_total[l] / desde_rebalance - custo_medio[l]);
+                    }
+                    desb = Desbalanceamento(linha_ini, custo_medio, size);
+
+                    if (desb > LIMIAR_DESBALANCEAMENTO) {
+                        memcpy(linha_nova, linha_ini, (size + 1) * sizeof(int));
+                        if (compartilhado) {
+                            for (int k = 0; k < no.num; k++) {
+                                int first_row, last_row;
+
+                                BlocoNo(&no, linha_ini, k, &first_row, &last_row);
+                                if (first_row <= last_row) {
+                                    ParticaoPorCusto(linha_nova + no.pos_ini[k], custo_medio, first_row, last_row,
+                                                     no.pos_ini[k + 1] - no.pos_ini[k]);
+                                }
+                            }
+                        }
+                        else {
+                            ParticaoPorCusto(linha_nova, custo_medio, 1, tam, size);
+                        }
+                        desb_nova = Desbalanceamento(linha_nova, custo_medio, size);
+                        mudou = desb_nova < desb - GANHO_MIN_REBALANCEAMENTO;
+                        if (mudou) {
+                            memcpy(linha_ini, linha_nova, (size + 1) * sizeof(int));
+                            printf("Rebalanceamento tam=%d ger=%d: desbalanceamento=%.2f -> %.2f; linhas:",
+                                   tam, 2 * (i + 1), desb, desb_nova);
+                            for (int r = 0; r < size; r++) {
+                                printf(" %d", linha_ini[r + 1] - linha_ini[r]);
+                            }
+                            printf("\n");
+                        }
+                    }
+                }
+
+                // Sem ganho suficiente a particao fica como esta
+                MPI_Bcast(&mudou, 1, MPI_INT, 0, MPI_COMM_WORLD);
+                if (mudou) {
+                    MPI_Bcast(linha_ini, size + 1, MPI_INT, 0, MPI_COMM_WORLD);
+                    AplicarParticao(linha_ini, tam, size, pos, recvcounts, displs, &local_start, &local_end);
+                }
+                memset(custo, 0, (tam + 2) * sizeof(double));
+                desde_rebalance = 0;
+            }
         }
 
         if (rank == 0) {
             t2 = wall_time();
+            if (telem) {
+                atomic_store_explicit(&telem->t_comp, t2 - t1, RELAXADO);
+                TelemFase(telem, TELEM_FIM, t2);
+            }
         }
 
         // Mostrar estado final
+        if (compartilhado) {
+            ReunirTabulNo(&no, tabulIn, tam, linha_ini);
+        }
         DumpTabul(tabulIn, tam, 1, tam, "Estado Final - Veleiro no canto inferior direito", rank);
 
-        // Verificacao do resultado apenas no processo 0
+        // Verificacao distribuida: contagem local + reducao no processo 0
+        int correto = Correto(tabulIn, tam, local_start, local_end);
+
         if (rank == 0) {
-            if (Correto(tabulIn, tam)) {
+            if (correto) {
                 printf("**RESULTADO CORRETO**\n");
             }
             else {
@@ -230,18 +704,44 @@ int main(int argc, char **argv) {
             }
 
             t3 = wall_time();
+            if (telem) {
+                atomic_store_explicit(&telem->t_fim, t3 - t2, RELAXADO);
+            }
             printf("tam=%d; processos=%d; tempos: init=%7.7f, comp=%7.7f, fim=%7.7f, tot=%7.7f \n", tam, size, t1 - t0, t2 - t1, t3 - t2, t3 - t0);
         }
 
-        free(tabulIn);
-        free(tabulOut);
-        free(temp_tabul);
+        if (compartilhado) {
+            LiberarTabulNo(&no);
+        }
+        else {
+            free(tabulIn);
+            free(temp_tabul);
+        }
+        free(custo);
+        free(custo_total);
+        free(custo_medio);
+        custo = custo_total = custo_medio = NULL;
     }
 
     free(recvcounts);
     free(displs);
+    free(linha_ini);
+    free(linha_nova);
+    if (compartilhado) {
+        LiberarInfoNo(&no);
+    }
+    if (nome_telem) {
+        // O processo 0 remove o segmento depois que todos desmapearam
+        if (telem && rank != 0) {
+            TelemFechar(telem, nome_telem, 0);
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (telem && rank == 0) {
+            TelemFechar(telem, nome_telem, 1);
+        }
+    }
 
     MPI_Finalize();
 
     return 0;
-}
\ No newline at end of file
+}
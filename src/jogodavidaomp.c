@@ -1,12 +1,44 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
 #include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 #include <omp.h>
+#include "telemetria.h"
+#include "blocos.h"
 
 #define ind2d(i, j) (i) * (tam + 2) + j
 #define POWMIN 3
 #define POWMAX 10
 
+// Modo servidor
+#define MAX_CLIENTES 64
+#define MAX_FILA 256
+#define TAM_BUF_CLIENTE 1024
+#define TAM_MAX_SERVIDOR 8192       // lado maximo de um pedido (2 tabuleiros de ~256 MiB)
+#define SAIDA_MAX_PENDENTE (1 << 20) // acima disso as tarefas do cliente esperam ele ler
+#define TAM_MIN_PARALELO 128 // abaixo disso o custo do fork/join domina
+
+// Kernels selecionaveis com -k
+#define KERNEL_CLASSICO 0
+#define KERNEL_MORTON 1
+#define KERNEL_COLUNAS 2
+#define BLOCO_PADRAO 64
+
+// Autotuning (-T)
+#define MAX_CACHE 64
+#define RAZAO_MAX_CACHE 2.0 // entrada do cache so vale ate este fator de distancia em tam
+#define TEMPO_ENSAIO 0.02 // segundos minimos medidos por configuracao
+
+// Telemetria em memoria compartilhada (-t), NULL quando desligada
+static Telemetria *telem = NULL;
+
 
 double wall_time(void) {
     struct timeval tv;
@@ -18,29 +50,123 @@ double wall_time(void) {
 
 /* Funcao para aplicar as regras do Jogo da Vida com OpenMP */
 void UmaVidaOMP(int *tabulIn, int *tabulOut, int tam) {
-    int i, j, vizviv;
-
     // Paralelizacao do loop principal com OpenMP
-    #pragma omp parallel for private(i, j, vizviv) schedule(static)
-    for (i = 1; i <= tam; i++) {
-        for (j = 1; j <= tam; j++) {
-            vizviv = tabulIn[ind2d(i - 1, j - 1)] + tabulIn[ind2d(i - 1, j)] +
-                     tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
-                     tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
-                     tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
+    #pragma omp parallel
+    {
+        int i, j, vizviv, linhas = 0, vivas = 0;
 
-            if (tabulIn[ind2d(i, j)] && vizviv < 2) {
-                tabulOut[ind2d(i, j)] = 0;
+        // schedule(runtime): OMP_SCHEDULE, ou o escolhido pelo autotuning
+        #pragma omp for schedule(runtime) nowait
+        for (i = 1; i <= tam; i++) {
+            for (j = 1; j <= tam; j++) {
+                vizviv = tabulIn[ind2d(i - 1, j - 1)] + tabulIn[ind2d(i - 1, j)] +
+                         tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
+                         tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
+                         tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
+
+                if (tabulIn[ind2d(i, j)] && vizviv < 2) {
+                    tabulOut[ind2d(i, j)] = 0;
+                }
+                else if (tabulIn[ind2d(i, j)] && vizviv > 3) {
+                    tabulOut[ind2d(i, j)] = 0;
+                }
+                else if (!tabulIn[ind2d(i, j)] && vizviv == 3) {
+                    tabulOut[ind2d(i, j)] = 1;
+                }
+                else {
+                    tabulOut[ind2d(i, j)] = tabulIn[ind2d(i, j)];
+                }
             }
-            else if (tabulIn[ind2d(i, j)] && vizviv > 3) {
-                tabulOut[ind2d(i, j)] = 0;
+            // Populacao so com telemetria, fora do laco interno
+            if (telem) {
+                for (j = 1; j <= tam; j++) {
+                    vivas += tabulOut[ind2d(i, j)];
+                }
             }
-            else if (!tabulIn[ind2d(i, j)] && vizviv == 3) {
-                tabulOut[ind2d(i, j)] = 1;
+            linhas++;
+        }
+        if (telem) {
+            TelemTrabalho(telem, omp_get_thread_num(), linhas, vivas);
+        }
+    }
+}
+
+/* Kernel de somas de colunas: soma[j] guarda a soma vertical das 3
+   celulas da coluna j em torno da linha i, calculada uma vez por coluna; a
+   vizinhanca e a janela soma[j-1] + soma[j] + soma[j+1] menos a propria
+   celula. Cada thread tem seu vetor de somas (VLA privado da regiao). */
+void UmaVidaOMPColunas(int *tabulIn, int *tabulOut, int tam) {
+    #pragma omp parallel
+    {
+        int i, j, vizviv, linhas = 0, vivas = 0;
+        int soma[tam + 2];
+
+        #pragma omp for schedule(runtime) nowait
+        for (i = 1; i <= tam; i++) {
+            for (j = 0; j <= tam + 1; j++) {
+                soma[j] = tabulIn[ind2d(i - 1, j)] + tabulIn[ind2d(i, j)] + tabulIn[ind2d(i + 1, j)];
             }
-            else {
-                tabulOut[ind2d(i, j)] = tabulIn[ind2d(i, j)];
+            for (j = 1; j <= tam; j++) {
+                vizviv = soma[j - 1] + soma[j] + soma[j + 1] - tabulIn[ind2d(i, j)];
+                tabulOut[ind2d(i, j)] = (vizviv == 3) | (tabulIn[ind2d(i, j)] & (vizviv == 2));
+            }
+            if (telem) {
+                for (j = 1; j <= tam; j++) {
+                    vivas += tabulOut[ind2d(i, j)];
+                }
             }
+            linhas++;
+        }
+        if (telem) {
+            TelemTrabalho(telem, omp_get_thread_num(), linhas, vivas);
+        }
+    }
+}
+
+/* Layout em blocos (blocos.h). A conversao percorre os blocos com a mesma
+   distribuicao estatica do kernel, de forma que o primeiro toque de cada
+   bloco ocorre na thread que vai processa-lo. */
+void ParaBlocos(int *tabul, TabulBlocos *tb) {
+    int k;
+
+    #pragma omp parallel for schedule(static)
+    for (k = 0; k < tb->nb * tb->nb; k++) {
+        ParaBloco(tabul, tb->tam + 2, tb, k);
+    }
+}
+
+void DeBlocos(TabulBlocos *tb, int *tabul) {
+    int k;
+
+    #pragma omp parallel for schedule(static)
+    for (k = 0; k < tb->nb * tb->nb; k++) {
+        DeBloco(tb, k, tabul, tb->tam + 2);
+    }
+}
+
+/* Uma geracao no layout em blocos: atualiza as bordas da entrada e percorre
+   os blocos em ordem Z; cada thread recebe uma faixa contigua da curva Z */
+void UmaVidaBlocos(TabulBlocos *in, TabulBlocos *out) {
+    int k, n = in->nb * in->nb;
+
+    #pragma omp parallel private(k)
+    {
+        int blocos = 0, vivas = 0;
+
+        #pragma omp for schedule(static)
+        for (k = 0; k < n; k++) {
+            AtualizarBordas(in, k);
+        }
+        #pragma omp for schedule(static) nowait
+        for (k = 0; k < n; k++) {
+            UmaVidaBloco(in, out, k);
+            if (telem) {
+                vivas += VivasBloco(out, k);
+            }
+            blocos++;
+        }
+        if (telem) {
+            TelemTrabalho(telem, omp_get_thread_num(), blocos, vivas);
         }
     }
 }
@@ -49,8 +175,9 @@ void UmaVidaOMP(int *tabulIn, int *tabulOut, int tam) {
 void InitTabul(int *tabulIn, int *tabulOut, int tam) {
     int ij;
 
-    // Paralelizacao da inicializacao
-    #pragma omp parallel for
+    // Paralelizacao da inicializacao; tabuleiros pequenos (tarefas curtas do
+    // modo servidor) zeram sem abrir regiao paralela
+    #pragma omp parallel for if (tam >= TAM_MIN_PARALELO)
     for (ij = 0; ij < (tam + 2) * (tam + 2); ij++) {
         tabulIn[ij] = 0;
         tabulOut[ij] = 0;
@@ -78,11 +205,837 @@ int Correto(int *tabul, int tam) {
             tabul[ind2d(tam, tam - 1)] && tabul[ind2d(tam, tam)]);
 }
 
-int main(void) {
-    int pow;
+/* Evolucao com regra generica B/S: bit n de nasce/sobrevive indica se uma
+   celula morta/viva com n vizinhos vivos fica viva. Tabuleiros pequenos
+   rodam sem abrir regiao paralela. */
+void UmaVidaOMPRegra(int *tabulIn, int *tabulOut, int tam, int nasce, int sobrevive) {
+    int i, j, vizviv;
+
+    #pragma omp parallel for private(i, j, vizviv) schedule(static) if (tam >= TAM_MIN_PARALELO)
+    for (i = 1; i <= tam; i++) {
+        for (j = 1; j <= tam; j++) {
+            vizviv = tabulIn[ind2d(i - 1, j - 1)] + tabulIn[ind2d(i - 1, j)] +
+                     tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
+                     tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
+                     tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
+
+            tabulOut[ind2d(i, j)] = ((tabulIn[ind2d(i, j)] ? sobrevive : nasce) >> vizviv) & 1;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+   Modo servidor: processo residente que atende tarefas por um socket Unix.
+   O time OpenMP e os tabuleiros ficam alocados entre tarefas.
+
+   Protocolo (uma tarefa por linha):
+     <tam> <geracoes> <padrao> <regra> [tabuleiro]
+       padrao: veleiro | aleatorio:<semente>
+       regra:  B<digitos>/S<digitos>, ex. B3/S23
+   Resposta (na ordem dos pedidos de cada cliente):
+     ok tam=<n> geracoes=<g> vivas=<v> tempo=<s> linhas=<l>
+     seguida de <l> linhas com o tabuleiro final ('X' viva, '.' morta)
+     ou: erro <mensagem>
+   As respostas vao para um buffer de saida por cliente, esvaziado com
+   POLLOUT pelo proprio laco de poll(): um cliente que para de ler nao
+   bloqueia os demais. O servidor encerra com SIGINT ou SIGTERM.
+   --------------------------------------------------------------------------- */
+
+typedef struct {
+    int fd;
+    int tam, geracoes;
+    int semente; // -1 = veleiro
+    int nasce, sobrevive;
+    int tabuleiro;
+    const char *erro; // pedido invalido: responde apenas com o erro
+} Tarefa;
+
+typedef struct {
+    int fd;
+    int len;
+    int eof; // cliente fechou a escrita: atende o que falta e fecha
+    char buf[TAM_BUF_CLIENTE];
+    char *saida; // respostas ainda nao enviadas: saida[ini, fim)
+    size_t saida_ini, saida_fim, saida_cap;
+} Cliente;
+
+typedef struct {
+    int fd;
+    Cliente clientes[MAX_CLIENTES];
+    int nclientes;
+    Tarefa fila[MAX_FILA];
+    int fila_ini, fila_len;
+    int *tabulIn, *tabulOut; // reaproveitados entre tarefas
+    size_t cap_celulas;
+} Servidor;
+
+static volatile sig_atomic_t servidor_sair = 0;
+
+/* Le uma regra no formato B<digitos>/S<digitos> */
+int LerRegra(const char *txt, int *nasce, int *sobrevive) {
+    int *alvo = NULL;
+
+    *nasce = *sobrevive = 0;
+    for (; *txt; txt++) {
+        if (*txt == 'B' || *txt == 'b') {
+            alvo = nasce;
+        }
+        else if (*txt == 'S' || *txt == 's') {
+            alvo = sobrevive;
+        }
+        else if (*txt >= '0' && *txt <= '8' && alvo) {
+            *alvo |= 1 << (*txt - '0');
+        }
+        else if (*txt != '/') {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Preenche o tabuleiro com o veleiro (semente < 0) ou com celulas aleatorias
+   geradas por hash da posicao, o que permite inicializacao paralela */
+void InitPadrao(int *tabulIn, int *tabulOut, int tam, int semente) {
+    int ij, i, j;
+
+    InitTabul(tabulIn, tabulOut, tam);
+    if (semente < 0) {
+        return;
+    }
+
+    #pragma omp parallel for private(i, j, ij) if (tam >= TAM_MIN_PARALELO)
+    for (i = 1; i <= tam; i++) {
+        for (j = 1; j <= tam; j++) {
+            ij = ind2d(i, j);
+            unsigned int h = ((unsigned int)ij * 2654435761u) ^ (unsigned int)semente;
+            h ^= h >> 16;
+            h *= 0x45d9f3bu;
+            h ^= h >> 16;
+            tabulIn[ij] = h & 1;
+        }
+    }
+}
+
+int ContaVivas(int *tabul, int tam) {
+    int i, j, cnt = 0;
+
+    #pragma omp parallel for private(j) reduction(+ : cnt) if (tam >= TAM_MIN_PARALELO)
+    for (i = 1; i <= tam; i++) {
+        for (j = 1; j <= tam; j++) {
+            cnt += tabul[ind2d(i, j)];
+        }
+    }
+    return cnt;
+}
+
+/* Erro enviado direto num socket sem cliente (servidor cheio, linha muito
+   longa): uma unica tentativa, sem esperar o socket */
+void EnviarErro(int fd, const char *msg) {
+    char linha[256];
+
+    snprintf(linha, sizeof(linha), "erro %s\n", msg);
+    send(fd, linha, strlen(linha), MSG_NOSIGNAL | MSG_DONTWAIT);
+}
+
+Cliente *ClientePorFd(Servidor *srv, int fd) {
+    int c;
+
+    for (c = 0; c < srv->nclientes; c++) {
+        if (srv->clientes[c].fd == fd) {
+            return &srv->clientes[c];
+        }
+    }
+    return NULL;
+}
+
+/* Reserva n bytes no fim do buffer de saida do cliente */
+char *ReservarSaida(Cliente *cl, size_t n) {
+    char *novo;
+    size_t cap;
+
+    if (cl->saida_ini == cl->saida_fim) {
+        cl->saida_ini = cl->saida_fim = 0;
+    }
+    if (cl->saida_fim + n > cl->saida_cap) {
+        cap = cl->saida_cap ? cl->saida_cap : 4096;
+        while (cap < cl->saida_fim + n) {
+            cap *= 2;
+        }
+        novo = (char *)realloc(cl->saida, cap);
+        if (!novo) {
+            return NULL;
+        }
+        cl->saida = novo;
+        cl->saida_cap = cap;
+    }
+    return cl->saida + cl->saida_fim;
+}
+
+/* Envia o que o socket aceitar sem bloquear; retorna -1 em erro de conexao */
+int EnviarSaida(Cliente *cl) {
+    ssize_t r;
+
+    while (cl->saida_ini < cl->saida_fim) {
+        r = send(cl->fd, cl->saida + cl->saida_ini, cl->saida_fim - cl->saida_ini, MSG_NOSIGNAL);
+        if (r > 0) {
+            cl->saida_ini += r;
+        }
+        else if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        else {
+            return r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+    }
+    return 0;
+}
+
+void ResponderErro(Cliente *cl, const char *msg) {
+    size_t n = strlen(msg) + 6;
+    char *dst = ReservarSaida(cl, n + 1);
+
+    if (dst) {
+        snprintf(dst, n + 1, "erro %s\n", msg);
+        cl->saida_fim += n;
+    }
+}
+
+/* Interpreta uma linha do protocolo e enfileira a tarefa. Pedidos invalidos
+   tambem entram na fila para que as respostas saiam na ordem dos pedidos. */
+void ReceberLinha(Servidor *srv, int fd, char *linha) {
+    char padrao[64], regra[64], extra[64];
+    Tarefa *t;
+    int n;
+
+    t = &srv->fila[(srv->fila_ini + srv->fila_len) % MAX_FILA];
+    srv->fila_len++;
+    t->fd = fd;
+    t->erro = NULL;
+    extra[0] = '\0';
+
+    n = sscanf(linha, "%d %d %63s %63s %63s", &t->tam, &t->geracoes, padrao, regra, extra);
+    if (n < 4) {
+        t->erro = "uso: <tam> <geracoes> <veleiro|aleatorio:semente> <regra> [tabuleiro]";
+    }
+    else if (t->tam < 4 || t->geracoes < 0) {
+        t->erro = "tamanho ou geracoes invalidos";
+    }
+    else if (t->tam > TAM_MAX_SERVIDOR) {
+        t->erro = "tamanho acima do maximo do servidor";
+    }
+    else if (LerRegra(regra, &t->nasce, &t->sobrevive) != 0) {
+        t->erro = "regra invalida";
+    }
+    else if (strcmp(padrao, "veleiro") == 0) {
+        t->semente = -1;
+    }
+    else if (sscanf(padrao, "aleatorio:%d", &t->semente) != 1 || t->semente < 0) {
+        t->erro = "padrao invalido";
+    }
+    t->tabuleiro = strcmp(extra, "tabuleiro") == 0;
+}
+
+/* Executa uma tarefa reaproveitando os tabuleiros do servidor; a resposta
+   vai para o buffer de saida do cliente */
+void ExecutarTarefa(Servidor *srv, Tarefa *t) {
+    Cliente *cl = ClientePorFd(srv, t->fd);
+    int tam = t->tam;
+    size_t celulas = (size_t)(tam + 2) * (tam + 2);
+    int g, i, j, vivas, *a, *b, *tmp;
+    size_t n, cap;
+    char *resp;
+    double t0;
+
+    if (!cl) {
+        return;
+    }
+    if (t->erro) {
+        ResponderErro(cl, t->erro);
+        return;
+    }
+
+    if (celulas > srv->cap_celulas) {
+        free(srv->tabulIn);
+        free(srv->tabulOut);
+        srv->tabulIn = (int *)malloc(celulas * sizeof(int));
+        srv->tabulOut = (int *)malloc(celulas * sizeof(int));
+        srv->cap_celulas = celulas;
+        if (!srv->tabulIn || !srv->tabulOut) {
+            free(srv->tabulIn);
+            free(srv->tabulOut);
+            srv->tabulIn = srv->tabulOut = NULL;
+            srv->cap_celulas = 0;
+            ResponderErro(cl, "sem memoria");
+            return;
+        }
+    }
+
+    // Reserva a resposta antes de calcular: sem memoria, nada e executado
+    cap = 128 + (t->tabuleiro ? (size_t)tam * (tam + 1) : 0);
+    resp = ReservarSaida(cl, cap);
+    if (!resp) {
+        ResponderErro(cl, "sem memoria");
+        return;
+    }
+
+    t0 = wall_time();
+    a = srv->tabulIn;
+    b = srv->tabulOut;
+    InitPadrao(a, b, tam, t->semente);
+    for (g = 0; g < t->geracoes; g++) {
+        UmaVidaOMPRegra(a, b, tam, t->nasce, t->sobrevive);
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+    vivas = ContaVivas(a, tam);
+
+    n = snprintf(resp, 128, "ok tam=%d geracoes=%d vivas=%d tempo=%.6f linhas=%d\n",
+                 tam, t->geracoes, vivas, wall_time() - t0, t->tabuleiro ? tam : 0);
+    if (t->tabuleiro) {
+        for (i = 1; i <= tam; i++) {
+            for (j = 1; j <= tam; j++) {
+                resp[n++] = a[ind2d(i, j)] ? 'X' : '.';
+            }
+            resp[n++] = '\n';
+        }
+    }
+    cl->saida_fim += n;
+}
+
+void FecharCliente(Servidor *srv, int c) {
+    int k;
+
+    // Tarefas pendentes do cliente sao descartadas
+    for (k = 0; k < srv->fila_len; k++) {
+        if (srv->fila[(srv->fila_ini + k) % MAX_FILA].fd == srv->clientes[c].fd) {
+            srv->fila[(srv->fila_ini + k) % MAX_FILA].fd = -1;
+        }
+    }
+    close(srv->clientes[c].fd);
+    free(srv->clientes[c].saida);
+    srv->clientes[c] = srv->clientes[--srv->nclientes];
+}
+
+/* Enfileira as linhas completas do buffer do cliente enquanto houver espaco
+   na fila; o restante fica no buffer (contrapressao) */
+void ProcessarLinhas(Servidor *srv, int c) {
+    Cliente *cl = &srv->clientes[c];
+    char *fim;
+
+    while (srv->fila_len < MAX_FILA && (fim = strchr(cl->buf, '\n')) != NULL) {
+        *fim = '\0';
+        if (fim > cl->buf && fim[-1] == '\r') {
+            fim[-1] = '\0';
+        }
+        if (cl->buf[0] != '\0') {
+            ReceberLinha(srv, cl->fd, cl->buf);
+        }
+        cl->len -= fim + 1 - cl->buf;
+        memmove(cl->buf, fim + 1, cl->len + 1);
+    }
+}
+
+/* Cliente que ja fechou a escrita, sem pedidos nem respostas pendentes */
+int ClienteConcluido(Servidor *srv, int c) {
+    int k;
+
+    if (!srv->clientes[c].eof || strchr(srv->clientes[c].buf, '\n') ||
+        srv->clientes[c].saida_ini < srv->clientes[c].saida_fim) {
+        return 0;
+    }
+    for (k = 0; k < srv->fila_len; k++) {
+        if (srv->fila[(srv->fila_ini + k) % MAX_FILA].fd == srv->clientes[c].fd) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Le dados disponiveis de um cliente; retorna -1 em erro de conexao */
+int LerCliente(Servidor *srv, int c) {
+    Cliente *cl = &srv->clientes[c];
+    ssize_t r;
+
+    r = recv(cl->fd, cl->buf + cl->len, TAM_BUF_CLIENTE - 1 - cl->len, 0);
+    if (r == 0) {
+        cl->eof = 1;
+        return 0;
+    }
+    if (r < 0) {
+        return errno == EAGAIN || errno == EINTR ? 0 : -1;
+    }
+    cl->len += r;
+    cl->buf[cl->len] = '\0';
+
+    ProcessarLinhas(srv, c);
+    if (cl->len == TAM_BUF_CLIENTE - 1 && !strchr(cl->buf, '\n')) {
+        EnviarErro(cl->fd, "linha muito longa");
+        return -1;
+    }
+    return 0;
+}
+
+/* Cliente com respostas acumuladas acima do limite: para de ler e de ter
+   tarefas executadas ate esvaziar a saida */
+int ClienteCongestionado(Cliente *cl) {
+    return cl->saida_fim - cl->saida_ini > SAIDA_MAX_PENDENTE;
+}
+
+/* Posicao na fila da primeira tarefa executavel (a de cliente congestionado
+   espera, as demais seguem; a ordem por cliente se mantem) ou -1 */
+int ProximaTarefa(Servidor *srv) {
+    Cliente *cl;
+    int k;
+
+    for (k = 0; k < srv->fila_len; k++) {
+        cl = ClientePorFd(srv, srv->fila[(srv->fila_ini + k) % MAX_FILA].fd);
+        if (!cl || !ClienteCongestionado(cl)) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+/* Remove a tarefa da posicao k da fila */
+Tarefa RetirarTarefa(Servidor *srv, int k) {
+    Tarefa t = srv->fila[(srv->fila_ini + k) % MAX_FILA];
+
+    for (; k > 0; k--) {
+        srv->fila[(srv->fila_ini + k) % MAX_FILA] = srv->fila[(srv->fila_ini + k - 1) % MAX_FILA];
+    }
+    srv->fila_ini = (srv->fila_ini + 1) % MAX_FILA;
+    srv->fila_len--;
+    return t;
+}
+
+void TratarSinal(int sinal) {
+    (void)sinal;
+    servidor_sair = 1;
+}
+
+/* Laco orientado a eventos: aceita conexoes, le pedidos e esvazia as saidas
+   de todos os clientes com poll(); as tarefas entram numa fila FIFO e sao
+   executadas uma por vez, usando todas as threads, entre as rodadas de
+   poll() */
+int Servir(const char *caminho) {
+    Servidor srv;
+    struct sockaddr_un addr;
+    struct pollfd pfds[MAX_CLIENTES + 1];
+    struct sigaction sa;
+    Cliente *cl;
+    int c, fd, n, k;
+
+    memset(&srv, 0, sizeof(srv));
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(caminho) >= sizeof(addr.sun_path)) {
+        printf("Caminho do socket muito longo: %s\n", caminho);
+        return 1;
+    }
+    strcpy(addr.sun_path, caminho);
+
+    srv.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(caminho);
+    if (srv.fd < 0 || bind(srv.fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(srv.fd, MAX_CLIENTES) < 0) {
+        perror("socket");
+        return 1;
+    }
+    fcntl(srv.fd, F_SETFL, O_NONBLOCK);
+
+    // SIGINT/SIGTERM interrompem o poll() (sem SA_RESTART) e encerram o laco
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = TratarSinal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("Servidor ouvindo em %s com %d threads OpenMP\n", caminho, omp_get_max_threads());
+    fflush(stdout);
+
+    while (!servidor_sair) {
+        // Linhas que ficaram no buffer enquanto a fila estava cheia
+        for (c = 0; c < srv.nclientes && srv.fila_len < MAX_FILA; c++) {
+            if (!ClienteCongestionado(&srv.clientes[c])) {
+                ProcessarLinhas(&srv, c);
+            }
+        }
+        for (c = srv.nclientes - 1; c >= 0; c--) {
+            if (ClienteConcluido(&srv, c)) {
+                FecharCliente(&srv, c);
+            }
+        }
+
+        // Fila cheia, buffer cheio ou saida congestionada: para de ler do
+        // cliente; respostas pendentes pedem POLLOUT
+        pfds[0].fd = srv.fd;
+        pfds[0].events = POLLIN;
+        for (c = 0; c < srv.nclientes; c++) {
+            cl = &srv.clientes[c];
+            pfds[c + 1].fd = cl->fd;
+            pfds[c + 1].events = !cl->eof && srv.fila_len < MAX_FILA && cl->len < TAM_BUF_CLIENTE - 1 &&
+                                         !ClienteCongestionado(cl)
+                                     ? POLLIN
+                                     : 0;
+            if (cl->saida_ini < cl->saida_fim) {
+                pfds[c + 1].events |= POLLOUT;
+            }
+        }
+
+        // Com tarefas executaveis na fila, apenas verifica eventos sem bloquear
+        k = ProximaTarefa(&srv);
+        n = poll(pfds, srv.nclientes + 1, k >= 0 ? 0 : -1);
+        if (n < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+
+        for (c = srv.nclientes - 1; c >= 0 && n > 0; c--) {
+            if ((pfds[c + 1].revents & POLLOUT) && EnviarSaida(&srv.clientes[c]) < 0) {
+                FecharCliente(&srv, c);
+            }
+            else if ((pfds[c + 1].events & POLLIN) && (pfds[c + 1].revents & ~POLLOUT) &&
+                     LerCliente(&srv, c) < 0) {
+                FecharCliente(&srv, c);
+            }
+        }
+
+        if (n > 0 && (pfds[0].revents & POLLIN)) {
+            while ((fd = accept(srv.fd, NULL, NULL)) >= 0) {
+                if (srv.nclientes == MAX_CLIENTES) {
+                    EnviarErro(fd, "servidor cheio");
+                    close(fd);
+                    continue;
+                }
+                fcntl(fd, F_SETFL, O_NONBLOCK);
+                cl = &srv.clientes[srv.nclientes];
+                memset(cl, 0, sizeof(*cl));
+                cl->fd = fd;
+                srv.nclientes++;
+            }
+        }
+
+        // Uma tarefa por rodada; a resposta ja e enviada no que o socket
+        // aceitar, o resto sai com POLLOUT nas proximas rodadas
+        k = ProximaTarefa(&srv);
+        if (k >= 0) {
+            Tarefa t = RetirarTarefa(&srv, k);
+
+            if (t.fd >= 0) {
+                ExecutarTarefa(&srv, &t);
+                for (c = 0; c < srv.nclientes; c++) {
+                    if (srv.clientes[c].fd == t.fd && EnviarSaida(&srv.clientes[c]) < 0) {
+                        FecharCliente(&srv, c);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    for (c = srv.nclientes - 1; c >= 0; c--) {
+        FecharCliente(&srv, c);
+    }
+    close(srv.fd);
+    unlink(caminho);
+    free(srv.tabulIn);
+    free(srv.tabulOut);
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+   Autotuning: para cada tamanho, ensaios curtos de cada combinacao de kernel,
+   lado de bloco (morton), numero de threads e schedule (kernels por linha).
+   As vencedoras sao gravadas num cache por host e usadas nas execucoes
+   seguintes que nao fixam -k/-b.
+   --------------------------------------------------------------------------- */
+
+typedef struct {
+    int tam, kernel, bloco, threads;
+    omp_sched_t sched;
+    double t_ger; // segundos por geracao no ensaio
+} Config;
+
+static const char *NomeKernel(int kernel) {
+    return kernel == KERNEL_MORTON ? "morton" : kernel == KERNEL_COLUNAS ? "colunas" : "classico";
+}
+
+static int KernelPorNome(const char *nome) {
+    if (strcmp(nome, "morton") == 0) return KERNEL_MORTON;
+    if (strcmp(nome, "colunas") == 0) return KERNEL_COLUNAS;
+    if (strcmp(nome, "classico") == 0) return KERNEL_CLASSICO;
+    return -1;
+}
+
+static const char *NomeSched(omp_sched_t sched) {
+    return sched == omp_sched_dynamic ? "dynamic" : sched == omp_sched_guided ? "guided" : "static";
+}
+
+static int SchedPorNome(const char *nome, omp_sched_t *sched) {
+    if (strcmp(nome, "static") == 0) *sched = omp_sched_static;
+    else if (strcmp(nome, "dynamic") == 0) *sched = omp_sched_dynamic;
+    else if (strcmp(nome, "guided") == 0) *sched = omp_sched_guided;
+    else return -1;
+    return 0;
+}
+
+/* Cache em $JOGODAVIDA_TUNING ou ./tuning_<host>.txt */
+void CaminhoCache(char *caminho, size_t n) {
+    const char *env = getenv("JOGODAVIDA_TUNING");
+    char host[256];
+
+    if (env && *env) {
+        snprintf(caminho, n, "%s", env);
+        return;
+    }
+    if (gethostname(host, sizeof(host)) != 0) {
+        strcpy(host, "local");
+    }
+    host[sizeof(host) - 1] = '\0';
+    snprintf(caminho, n, "tuning_%s.txt", host);
+}
+
+/* Formato: uma linha por tamanho, "tam kernel bloco threads schedule t_ger";
+   linhas iniciadas por '#' sao comentarios. Retorna o numero de entradas. */
+int CarregarCache(const char *caminho, Config *cfg, int max) {
+    FILE *f = fopen(caminho, "r");
+    char linha[256], kernel[32], sched[32];
+    int n = 0;
+
+    if (!f) {
+        return 0;
+    }
+    while (n < max && fgets(linha, sizeof(linha), f)) {
+        Config c;
+
+        if (linha[0] == '#' ||
+            sscanf(linha, "%d %31s %d %d %31s %lf", &c.tam, kernel, &c.bloco, &c.threads, sched, &c.t_ger) != 6) {
+            continue;
+        }
+        c.kernel = KernelPorNome(kernel);
+        if (c.tam < 4 || c.kernel < 0 || c.bloco < 1 || c.threads < 1 || SchedPorNome(sched, &c.sched) != 0) {
+            continue;
+        }
+        cfg[n++] = c;
+    }
+    fclose(f);
+    return n;
+}
+
+/* Mescla as novas configuracoes com as ja gravadas (substitui o mesmo tam) */
+int SalvarCache(const char *caminho, const Config *novas, int nnovas) {
+    Config cfg[MAX_CACHE];
+    int n = CarregarCache(caminho, cfg, MAX_CACHE), k, m;
+    char host[256] = "local";
+    FILE *f;
+
+    for (k = 0; k < nnovas; k++) {
+        for (m = 0; m < n && cfg[m].tam != novas[k].tam; m++)
+            ;
+        if (m < n) {
+            cfg[m] = novas[k];
+        }
+        else if (n < MAX_CACHE) {
+            cfg[n++] = novas[k];
+        }
+    }
+
+    f = fopen(caminho, "w");
+    if (!f) {
+        return -1;
+    }
+    gethostname(host, sizeof(host) - 1);
+    fprintf(f, "# jogodavidaomp -T, host=%s\n# tam kernel bloco threads schedule t_ger\n", host);
+    for (k = 0; k < n; k++) {
+        fprintf(f, "%d %s %d %d %s %.9f\n", cfg[k].tam, NomeKernel(cfg[k].kernel), cfg[k].bloco,
+                cfg[k].threads, NomeSched(cfg[k].sched), cfg[k].t_ger);
+    }
+    return fclose(f);
+}
+
+/* Entrada do cache mais proxima de tam (em escala logaritmica), ou NULL se
+   a mais proxima estiver a mais de RAZAO_MAX_CACHE vezes de distancia */
+const Config *BuscarConfig(const Config *cfg, int n, int tam) {
+    const Config *melhor = NULL;
+    double d, dmelhor = 0;
+    int k;
+
+    for (k = 0; k < n; k++) {
+        d = cfg[k].tam > tam ? (double)cfg[k].tam / tam : (double)tam / cfg[k].tam;
+        if (!melhor || d < dmelhor) {
+            melhor = &cfg[k];
+            dmelhor = d;
+        }
+    }
+    return melhor && dmelhor <= RAZAO_MAX_CACHE ? melhor : NULL;
+}
+
+void AplicarConfig(const Config *c) {
+    omp_set_num_threads(c->threads);
+    omp_set_schedule(c->sched, 0);
+}
+
+/* Ensaio curto: uma geracao de aquecimento, depois pares de geracoes ate
+   TEMPO_ENSAIO segundos (no maximo as 4 * (tam - 3) da execucao real).
+   Retorna o tempo medio por geracao, ou um valor negativo em erro. */
+double Ensaio(const Config *c, int *tabulIn, int *tabulOut) {
+    TabulBlocos blA, blB;
+    double t0, t;
+    int tam = c->tam, g = 0;
+
+    AplicarConfig(c);
+    InitTabul(tabulIn, tabulOut, tam);
+    if (c->kernel == KERNEL_MORTON) {
+        if (CriarBlocos(&blA, tam, c->bloco) != 0) {
+            return -1;
+        }
+        if (CriarBlocos(&blB, tam, c->bloco) != 0) {
+            LiberarBlocos(&blA);
+            return -1;
+        }
+        ParaBlocos(tabulIn, &blA);
+        UmaVidaBlocos(&blA, &blB);
+    }
+    else if (c->kernel == KERNEL_COLUNAS) {
+        UmaVidaOMPColunas(tabulIn, tabulOut, tam);
+    }
+    else {
+        UmaVidaOMP(tabulIn, tabulOut, tam);
+    }
+
+    t0 = wall_time();
+    do {
+        if (c->kernel == KERNEL_MORTON) {
+            UmaVidaBlocos(&blB, &blA);
+            UmaVidaBlocos(&blA, &blB);
+        }
+        else if (c->kernel == KERNEL_COLUNAS) {
+            UmaVidaOMPColunas(tabulOut, tabulIn, tam);
+            UmaVidaOMPColunas(tabulIn, tabulOut, tam);
+        }
+        else {
+            UmaVidaOMP(tabulOut, tabulIn, tam);
+            UmaVidaOMP(tabulIn, tabulOut, tam);
+        }
+        g += 2;
+        t = wall_time() - t0;
+    } while (t < TEMPO_ENSAIO && g < 4 * (tam - 3));
+
+    if (c->kernel == KERNEL_MORTON) {
+        LiberarBlocos(&blA);
+        LiberarBlocos(&blB);
+    }
+    return t / g;
+}
+
+/* Busca exaustiva no espaco de configuracoes para um tamanho */
+int Autotunar(int tam, Config *melhor) {
+    static const int blocos[] = {16, 32, 64, 128};
+    static const omp_sched_t scheds[] = {omp_sched_static, omp_sched_dynamic, omp_sched_guided};
+    int max_threads = omp_get_max_threads();
+    int *tabulIn, *tabulOut, th, kernel, b, s;
+    Config c;
+
+    tabulIn = (int *)malloc((tam + 2) * (tam + 2) * sizeof(int));
+    tabulOut = (int *)malloc((tam + 2) * (tam + 2) * sizeof(int));
+    if (!tabulIn || !tabulOut) {
+        free(tabulIn);
+        free(tabulOut);
+        return -1;
+    }
+
+    melhor->t_ger = -1;
+    c.tam = tam;
+    // Threads: potencias de dois ate o maximo, e o maximo
+    for (th = 1;; th = th * 2 < max_threads ? th * 2 : max_threads) {
+        c.threads = th;
+        for (kernel = KERNEL_CLASSICO; kernel <= KERNEL_COLUNAS; kernel++) {
+            c.kernel = kernel;
+            // Morton varia o lado do bloco; o schedule fica estatico (first-touch)
+            for (b = 0; b < (kernel == KERNEL_MORTON ? 4 : 1); b++) {
+                c.bloco = kernel == KERNEL_MORTON ? blocos[b] : BLOCO_PADRAO;
+                if (kernel == KERNEL_MORTON && b > 0 && blocos[b - 1] >= tam) {
+                    break;
+                }
+                for (s = 0; s < (kernel == KERNEL_MORTON ? 1 : 3); s++) {
+                    c.sched = scheds[s];
+                    c.t_ger = Ensaio(&c, tabulIn, tabulOut);
+                    printf("  tam=%d kernel=%s bloco=%d threads=%d schedule=%s t_ger=%.9f\n", tam,
+                           NomeKernel(c.kernel), c.bloco, c.threads, NomeSched(c.sched), c.t_ger);
+                    if (c.t_ger >= 0 && (melhor->t_ger < 0 || c.t_ger < melhor->t_ger)) {
+                        *melhor = c;
+                    }
+                }
+            }
+        }
+        if (th == max_threads) {
+            break;
+        }
+    }
+
+    free(tabulIn);
+    free(tabulOut);
+    return melhor->t_ger < 0 ? -1 : 0;
+}
+
+/* Telemetria apos cada par de geracoes; a populacao ja foi publicada por
+   cada thread no proprio kernel */
+void TelemPar(int geracao) {
+    if (telem) {
+        TelemGeracao(telem, geracao, wall_time());
+    }
+}
+
+int main(int argc, char **argv) {
+    int k, ntam, opt;
     int i, tam, *tabulIn, *tabulOut;
     double t0, t1, t2, t3;
     int num_threads;
+    char *socket_servidor = NULL, *nome_telem = NULL;
+    int kernel = KERNEL_CLASSICO, bloco = BLOCO_PADRAO, kernel_tam, bloco_tam;
+    int autotunar = 0, fixo = 0, ncache = 0, nnovas = 0;
+    int threads_env, sched_env, threads_padrao, chunk, chunk_padrao;
+    omp_sched_t sched, sched_padrao;
+    TabulBlocos blA, blB;
+    Config cache[MAX_CACHE], novas[MAX_CACHE];
+    const Config *cfg;
+    char caminho_cache[512];
+
+    // -S <caminho>: modo servidor residente num socket Unix
+    // -k classico|morton|colunas: kernel; -b <lado>: lado do bloco do layout morton
+    // -T: autotuning dos tamanhos pedidos, gravado no cache do host
+    // -t <nome>: telemetria ao vivo em /dev/shm/jogodavida_<nome> (jogodavida_top)
+    while ((opt = getopt(argc, argv, "S:k:b:Tt:")) != -1) {
+        if (opt == 'S') {
+            socket_servidor = optarg;
+        }
+        else if (opt == 't') {
+            nome_telem = optarg;
+        }
+        else if (opt == 'T') {
+            autotunar = 1;
+        }
+        else if (opt == 'k' && strcmp(optarg, "classico") == 0) {
+            kernel = KERNEL_CLASSICO;
+            fixo = 1;
+        }
+        else if (opt == 'k' && strcmp(optarg, "morton") == 0) {
+            kernel = KERNEL_MORTON;
+            fixo = 1;
+        }
+        else if (opt == 'k' && strcmp(optarg, "colunas") == 0) {
+            kernel = KERNEL_COLUNAS;
+            fixo = 1;
+        }
+        else if (opt == 'b' && atoi(optarg) > 0) {
+            bloco = atoi(optarg);
+            fixo = 1;
+        }
+        else {
+            printf("Uso: %s [-S caminho_socket] [-T] [-t nome_telemetria] [-k classico|morton|colunas] [-b lado_bloco] [tam ...]\n", argv[0]);
+            return 1;
+        }
+    }
 
     // Obter numero de threads configuradas
     #pragma omp parallel
@@ -94,25 +1047,164 @@ int main(void) {
         }
     }
 
+    if (socket_servidor) {
+        return Servir(socket_servidor);
+    }
+
+    // Os kernels por linha usam schedule(runtime); sem OMP_SCHEDULE, estatico
+    if (!getenv("OMP_SCHEDULE")) {
+        omp_set_schedule(omp_sched_static, 0);
+    }
+
+    // OMP_NUM_THREADS/OMP_SCHEDULE explicitos prevalecem sobre o cache;
+    // tamanhos sem entrada proxima no cache voltam a estes valores
+    threads_env = getenv("OMP_NUM_THREADS") != NULL;
+    sched_env = getenv("OMP_SCHEDULE") != NULL;
+    threads_padrao = omp_get_max_threads();
+    omp_get_schedule(&sched_padrao, &chunk_padrao);
+
+    // Tamanhos pela linha de comando (ex.: ./jogodavidaomp 1000 2000) ou a
+    // varredura padrao 2^POWMIN..2^POWMAX
+    ntam = optind < argc ? argc - optind : POWMAX - POWMIN + 1;
+
+    CaminhoCache(caminho_cache, sizeof(caminho_cache));
+    if (autotunar) {
+        for (k = 0; k < ntam && nnovas < MAX_CACHE; k++) {
+            tam = optind < argc ? atoi(argv[optind + k]) : 1 << (POWMIN + k);
+            if (tam < 4) {
+                printf("Tamanho invalido: %s (minimo 4)\n", argv[optind + k]);
+                return 1;
+            }
+            printf("Autotuning tam=%d\n", tam);
+            if (Autotunar(tam, &novas[nnovas]) != 0) {
+                printf("Erro de alocacao de memoria\n");
+                return 1;
+            }
+            cfg = &novas[nnovas++];
+            printf("Melhor: tam=%d kernel=%s bloco=%d threads=%d schedule=%s t_ger=%.9f\n", cfg->tam,
+                   NomeKernel(cfg->kernel), cfg->bloco, cfg->threads, NomeSched(cfg->sched), cfg->t_ger);
+        }
+        if (SalvarCache(caminho_cache, novas, nnovas) != 0) {
+            printf("Erro ao gravar o cache de autotuning %s: %s\n", caminho_cache, strerror(errno));
+            return 1;
+        }
+        printf("Cache de autotuning gravado em %s\n", caminho_cache);
+        return 0;
+    }
+
+    // Sem -k/-b, cada tamanho usa a configuracao do cache (se houver)
+    if (!fixo) {
+        ncache = CarregarCache(caminho_cache, cache, MAX_CACHE);
+        if (ncache > 0) {
+            printf("Usando cache de autotuning %s (%d tamanhos)\n", caminho_cache, ncache);
+        }
+    }
+
+    // Um slot de telemetria por thread: o cache pode pedir mais threads que
+    // as do inicio (ajustado com um OMP_NUM_THREADS maior)
+    if (nome_telem) {
+        int ntrab = threads_padrao;
+
+        for (i = 0; i < ncache && !threads_env; i++) {
+            if (cache[i].threads > ntrab) {
+                ntrab = cache[i].threads;
+            }
+        }
+        telem = TelemCriar(nome_telem, "omp", ntrab);
+        if (!telem) {
+            printf("Erro ao criar a telemetria %s: %s\n", nome_telem, strerror(errno));
+            return 1;
+        }
+    }
+
     // Loop para todos os tamanhos do tabuleiro
-    for (pow = POWMIN; pow <= POWMAX; pow++) {
-        tam = 1 << pow;
+    for (k = 0; k < ntam; k++) {
+        tam = optind < argc ? atoi(argv[optind + k]) : 1 << (POWMIN + k);
+        if (tam < 4) {
+            printf("Tamanho invalido: %s (minimo 4)\n", argv[optind + k]);
+            return 1;
+        }
+
+        kernel_tam = kernel;
+        bloco_tam = bloco;
+        if (ncache > 0) {
+            cfg = BuscarConfig(cache, ncache, tam);
+            omp_set_num_threads(cfg && !threads_env ? cfg->threads : threads_padrao);
+            omp_set_schedule(cfg && !sched_env ? cfg->sched : sched_padrao, cfg && !sched_env ? 0 : chunk_padrao);
+            if (cfg) {
+                kernel_tam = cfg->kernel;
+                bloco_tam = cfg->bloco;
+            }
+            num_threads = omp_get_max_threads();
+            omp_get_schedule(&sched, &chunk);
+            if (cfg) {
+                printf("Config (cache tam=%d): ", cfg->tam);
+            }
+            else {
+                printf("Config (cache sem tamanho a ate %.0fx de tam=%d): ", RAZAO_MAX_CACHE, tam);
+            }
+            printf("kernel=%s bloco=%d threads=%d%s schedule=%s%s\n", NomeKernel(kernel_tam), bloco_tam, num_threads,
+                   threads_env ? " (OMP_NUM_THREADS)" : "", NomeSched(sched), sched_env ? " (OMP_SCHEDULE)" : "");
+        }
 
         // Alocacao e inicializacao dos tabuleiros
         t0 = wall_time();
+        if (telem) {
+            for (i = 0; i < telem->ntrab; i++) {
+                TelemZerarTrabalhador(telem, i);
+            }
+            TelemTamanhoNovo(telem, tam, 4 * (tam - 3), t0);
+        }
         tabulIn = (int *)malloc((tam + 2) * (tam + 2) * sizeof(int));
         tabulOut = (int *)malloc((tam + 2) * (tam + 2) * sizeof(int));
         InitTabul(tabulIn, tabulOut, tam);
+        if (kernel_tam == KERNEL_MORTON) {
+            if (CriarBlocos(&blA, tam, bloco_tam) != 0 || CriarBlocos(&blB, tam, bloco_tam) != 0) {
+                printf("Erro de alocacao de memoria\n");
+                return 1;
+            }
+            ParaBlocos(tabulIn, &blA);
+        }
         t1 = wall_time();
+        if (telem) {
+            atomic_store_explicit(&telem->t_init, t1 - t0, RELAXADO);
+            TelemFase(telem, TELEM_COMP, t1);
+        }
 
         // Loop principal de evolucao
-        for (i = 0; i < 2 * (tam - 3); i++)
-        {
-            UmaVidaOMP(tabulIn, tabulOut, tam);
-            UmaVidaOMP(tabulOut, tabulIn, tam);
+        if (kernel_tam == KERNEL_MORTON) {
+            for (i = 0; i < 2 * (tam - 3); i++) {
+                UmaVidaBlocos(&blA, &blB);
+                UmaVidaBlocos(&blB, &blA);
+                TelemPar(2 * (i + 1));
+            }
+        }
+        else if (kernel_tam == KERNEL_COLUNAS) {
+            for (i = 0; i < 2 * (tam - 3); i++) {
+                UmaVidaOMPColunas(tabulIn, tabulOut, tam);
+                UmaVidaOMPColunas(tabulOut, tabulIn, tam);
+                TelemPar(2 * (i + 1));
+            }
+        }
+        else {
+            for (i = 0; i < 2 * (tam - 3); i++) {
+                UmaVidaOMP(tabulIn, tabulOut, tam);
+                UmaVidaOMP(tabulOut, tabulIn, tam);
+                TelemPar(2 * (i + 1));
+            }
         }
 
         t2 = wall_time();
+        if (telem) {
+            atomic_store_explicit(&telem->t_comp, t2 - t1, RELAXADO);
+            TelemFase(telem, TELEM_FIM, t2);
+        }
+
+        if (kernel_tam == KERNEL_MORTON) {
+            DeBlocos(&blA, tabulIn);
+            LiberarBlocos(&blA);
+            LiberarBlocos(&blB);
+        }
 
         // Verificacao do resultado
         if (Correto(tabulIn, tam))
@@ -121,6 +1213,9 @@ int main(void) {
             printf("**RESULTADO ERRADO**\n");
 
         t3 = wall_time();
+        if (telem) {
+            atomic_store_explicit(&telem->t_fim, t3 - t2, RELAXADO);
+        }
         printf("tam=%d; threads=%d; tempos: init=%7.7f, comp=%7.7f, fim=%7.7f, tot=%7.7f \n",
                tam, num_threads, t1 - t0, t2 - t1, t3 - t2, t3 - t0);
 
@@ -128,5 +1223,9 @@ int main(void) {
         free(tabulOut);
     }
 
+    if (telem) {
+        TelemFechar(telem, nome_telem, 1);
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <sys/time.h>
 #include <omp.h>
 
@@ -9,7 +11,7 @@
 
 // Detectar se estamos em modo CPU fallback
 #ifdef CPU_FALLBACK
-#warning "Compilando OpenMP GPU em modo CPU fallback - sem offloading"
+#warning "Compilando OpenMP GPU em modo CPU fallback - regioes target no host"
 #define GPU_AVAILABLE 0
 #else
 #define GPU_AVAILABLE 1
@@ -24,70 +26,120 @@ double wall_time(void)
     return (tv.tv_sec + tv.tv_usec / 1000000.0);
 }
 
-/* Funcao para aplicar as regras do Jogo da Vida com OpenMP GPU offloading */
-void UmaVidaOMPGPU(int *tabulIn, int *tabulOut, int tam)
+// Modos de evolucao (-m)
+#define MODO_RESIDENTE 0  // buffer duplo residente no dispositivo, troca de ponteiros
+#define MODO_MAPEAMENTO 1 // mapeia os dois tabuleiros a cada geracao (comparacao)
+
+/* Regra de uma celula, compilada tambem para o dispositivo */
+#pragma omp declare target
+static inline int NovaCelula(const int *tabulIn, int tam, int i, int j)
 {
-    int total_cells = (tam + 2) * (tam + 2);
+    int vizviv = tabulIn[ind2d(i - 1, j - 1)] + tabulIn[ind2d(i - 1, j)] +
+                 tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
+                 tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
+                 tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
+
+    if (tabulIn[ind2d(i, j)] && vizviv < 2)
+        return 0;
+    else if (tabulIn[ind2d(i, j)] && vizviv > 3)
+        return 0;
+    else if (!tabulIn[ind2d(i, j)] && vizviv == 3)
+        return 1;
+    else
+        return tabulIn[ind2d(i, j)];
+}
+#pragma omp end declare target
 
+/* Dispositivo usado: o default se houver dispositivos de offload, senao o
+   proprio host (initial device). Em CPU_FALLBACK sempre o host. Nos dois
+   casos o caminho e o mesmo: regioes target sobre ponteiros de dispositivo. */
+int EscolherDispositivo(void)
+{
 #if GPU_AVAILABLE
-// Versão com GPU offloading
-#pragma omp target teams distribute parallel for collapse(2) \
-    map(to : tabulIn[0 : total_cells])                       \
-    map(from : tabulOut[0 : total_cells])
-#else
-// Fallback para CPU se GPU não disponível
-#pragma omp parallel for collapse(2)
+    if (omp_get_num_devices() > 0)
+        return omp_get_default_device();
 #endif
+    return omp_get_initial_device();
+}
+
+/* Par de tabuleiros residente no dispositivo (omp_target_alloc). O tabuleiro
+   atual e sempre a; cada geracao escreve em b e troca os ponteiros, sem
+   nenhum mapeamento entre geracoes. */
+typedef struct
+{
+    int dev, tam;
+    size_t bytes;
+    int *a, *b;
+} TabulDispositivo;
+
+int CriarTabulDispositivo(TabulDispositivo *td, int *tabul, int tam, int dev)
+{
+    int host = omp_get_initial_device();
+
+    td->dev = dev;
+    td->tam = tam;
+    td->bytes = (size_t)(tam + 2) * (tam + 2) * sizeof(int);
+    td->a = (int *)omp_target_alloc(td->bytes, dev);
+    td->b = (int *)omp_target_alloc(td->bytes, dev);
+    if (!td->a || !td->b)
+        return -1;
+
+    // Os dois buffers recebem o tabuleiro inicial: b precisa das bordas
+    // fantasma zeradas, que o kernel nunca escreve
+    if (omp_target_memcpy(td->a, tabul, td->bytes, 0, 0, dev, host) != 0 ||
+        omp_target_memcpy(td->b, tabul, td->bytes, 0, 0, dev, host) != 0)
+        return -1;
+    return 0;
+}
+
+/* Uma geracao a -> b no dispositivo, seguida da troca de ponteiros */
+void UmaVidaResidente(TabulDispositivo *td)
+{
+    const int *tabulIn = td->a;
+    int *tabulOut = td->b, *tmp;
+    int tam = td->tam;
+
+#pragma omp target teams distribute parallel for collapse(2) device(td->dev) \
+    is_device_ptr(tabulIn, tabulOut)
     for (int i = 1; i <= tam; i++)
     {
         for (int j = 1; j <= tam; j++)
         {
-            int vizviv = tabulIn[ind2d(i - 1, j - 1)] + tabulIn[ind2d(i - 1, j)] +
-                         tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
-                         tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
-                         tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
-
-            if (tabulIn[ind2d(i, j)] && vizviv < 2)
-                tabulOut[ind2d(i, j)] = 0;
-            else if (tabulIn[ind2d(i, j)] && vizviv > 3)
-                tabulOut[ind2d(i, j)] = 0;
-            else if (!tabulIn[ind2d(i, j)] && vizviv == 3)
-                tabulOut[ind2d(i, j)] = 1;
-            else
-                tabulOut[ind2d(i, j)] = tabulIn[ind2d(i, j)];
+            tabulOut[ind2d(i, j)] = NovaCelula(tabulIn, tam, i, j);
         }
     }
+
+    tmp = td->a;
+    td->a = td->b;
+    td->b = tmp;
+}
+
+int LerTabulDispositivo(TabulDispositivo *td, int *tabul)
+{
+    return omp_target_memcpy(tabul, td->a, td->bytes, 0, 0, omp_get_initial_device(), td->dev);
 }
 
-/* Versao alternativa com gestao explicita de dados */
-void UmaVidaOMPGPU_Managed(int *tabulIn, int *tabulOut, int tam)
+void LiberarTabulDispositivo(TabulDispositivo *td)
+{
+    omp_target_free(td->a, td->dev);
+    omp_target_free(td->b, td->dev);
+}
+
+/* Uma geracao mapeando os dois tabuleiros do host a cada chamada (modo de
+   comparacao: mede o custo do mapeamento por geracao). tabulOut e tofrom
+   para que as bordas fantasma voltem intactas. */
+void UmaVidaMapeada(int *tabulIn, int *tabulOut, int tam, int dev)
 {
     int total_cells = (tam + 2) * (tam + 2);
 
-// Mapeamento de dados mais explicito
-#pragma omp target data map(to : tabulIn[0 : total_cells]) \
-    map(from : tabulOut[0 : total_cells])
+#pragma omp target teams distribute parallel for collapse(2) device(dev) \
+    map(to : tabulIn[0 : total_cells])                                    \
+    map(tofrom : tabulOut[0 : total_cells])
+    for (int i = 1; i <= tam; i++)
     {
-#pragma omp target teams distribute parallel for collapse(2)
-        for (int i = 1; i <= tam; i++)
+        for (int j = 1; j <= tam; j++)
         {
-            for (int j = 1; j <= tam; j++)
-            {
-                int idx = ind2d(i, j);
-                int vizviv = tabulIn[ind2d(i - 1, j - 1)] + tabulIn[ind2d(i - 1, j)] +
-                             tabulIn[ind2d(i - 1, j + 1)] + tabulIn[ind2d(i, j - 1)] +
-                             tabulIn[ind2d(i, j + 1)] + tabulIn[ind2d(i + 1, j - 1)] +
-                             tabulIn[ind2d(i + 1, j)] + tabulIn[ind2d(i + 1, j + 1)];
-
-                if (tabulIn[idx] && vizviv < 2)
-                    tabulOut[idx] = 0;
-                else if (tabulIn[idx] && vizviv > 3)
-                    tabulOut[idx] = 0;
-                else if (!tabulIn[idx] && vizviv == 3)
-                    tabulOut[idx] = 1;
-                else
-                    tabulOut[idx] = tabulIn[idx];
-            }
+            tabulOut[ind2d(i, j)] = NovaCelula(tabulIn, tam, i, j);
         }
     }
 }
@@ -181,16 +233,32 @@ void check_gpu_devices()
     }
 #else
     printf("MODO CPU FALLBACK: Compilado sem suporte GPU offloading\n");
-    printf("Executando versao OpenMP CPU com paralelizacao de threads\n");
+    printf("Regioes target executadas no host (initial device)\n");
 #endif
 }
 
-int main(void)
+int main(int argc, char **argv)
 {
-    int pow;
+    int k, ntam, opt;
     int i, tam, *tabulIn, *tabulOut;
     double t0, t1, t2, t3;
-    int num_threads, num_devices;
+    int num_threads, num_devices, dev, modo = MODO_RESIDENTE;
+    TabulDispositivo td;
+
+    // -m residente|mapeamento: buffer duplo residente (padrao) ou mapeamento
+    // dos tabuleiros a cada geracao, para medir o custo do mapeamento
+    while ((opt = getopt(argc, argv, "m:")) != -1)
+    {
+        if (opt == 'm' && strcmp(optarg, "residente") == 0)
+            modo = MODO_RESIDENTE;
+        else if (opt == 'm' && strcmp(optarg, "mapeamento") == 0)
+            modo = MODO_MAPEAMENTO;
+        else
+        {
+            printf("Uso: %s [-m residente|mapeamento] [tam ...]\n", argv[0]);
+            return 1;
+        }
+    }
 
     // Verificar dispositivos GPU disponiveis
     check_gpu_devices();
@@ -212,22 +280,33 @@ int main(void)
     printf("Threads CPU: %d\n", num_threads);
     printf("Dispositivos GPU: %d\n", num_devices);
 
-    // Configurar dispositivo default (se disponivel)
-    if (num_devices > 0)
-    {
-        omp_set_default_device(0);
-        printf("Usando dispositivo GPU 0 como default\n");
-    }
+    // Dispositivo alvo: GPU 0 (default) se disponivel, senao o host
+    dev = EscolherDispositivo();
+    if (dev == omp_get_initial_device())
+        printf("Usando o host (initial device) como dispositivo alvo\n");
+    else
+        printf("Usando dispositivo GPU %d como default\n", dev);
+    printf("Evolucao: %s\n", modo == MODO_RESIDENTE ? "buffer duplo residente no dispositivo"
+                                                      : "mapeamento dos tabuleiros a cada geracao");
+
+    // Tamanhos pela linha de comando ou a varredura padrao 2^POWMIN..2^POWMAX
+    ntam = optind < argc ? argc - optind : POWMAX - POWMIN + 1;
 
     // Loop para todos os tamanhos do tabuleiro
-    for (pow = POWMIN; pow <= POWMAX; pow++)
+    for (k = 0; k < ntam; k++)
     {
-        tam = 1 << pow;
+        tam = optind < argc ? atoi(argv[optind + k]) : 1 << (POWMIN + k);
+        if (tam < 4)
+        {
+            printf("Tamanho invalido: %s (minimo 4)\n", argv[optind + k]);
+            return 1;
+        }
         int total_size = (tam + 2) * (tam + 2) * sizeof(int);
 
         printf("\n--- Processando tabuleiro %dx%d ---\n", tam, tam);
 
-        // Alocacao e inicializacao dos tabuleiros
+        // Alocacao e inicializacao dos tabuleiros; no modo residente a copia
+        // para o dispositivo entra no tempo de init e a volta no de fim
         t0 = wall_time();
         tabulIn = (int *)malloc(total_size);
         tabulOut = (int *)malloc(total_size);
@@ -239,84 +318,43 @@ int main(void)
         }
 
         InitTabul(tabulIn, tabulOut, tam);
+        if (modo == MODO_RESIDENTE && CriarTabulDispositivo(&td, tabulIn, tam, dev) != 0)
+        {
+            printf("Erro na alocacao de memoria do dispositivo!\n");
+            exit(1);
+        }
         t1 = wall_time();
 
-        // Usar a versao com gestao de dados se GPU disponivel, senao usar versao simples
-#if GPU_AVAILABLE
-        if (num_devices > 0)
+        // Loop principal de evolucao
+        if (modo == MODO_RESIDENTE)
         {
-            printf("Executando na GPU com gestao explicita de dados\n");
-
-// Loop principal de evolucao com gestao otimizada de dados
-#pragma omp target data map(tofrom : tabulIn[0 : (tam + 2) * (tam + 2)]) \
-    map(alloc : tabulOut[0 : (tam + 2) * (tam + 2)])
+            for (i = 0; i < 2 * (tam - 3); i++)
             {
-                for (i = 0; i < 2 * (tam - 3); i++)
-                {
-// Primeira evolucao: tabulIn -> tabulOut
-#pragma omp target teams distribute parallel for collapse(2)
-                    for (int ii = 1; ii <= tam; ii++)
-                    {
-                        for (int jj = 1; jj <= tam; jj++)
-                        {
-                            int idx = ind2d(ii, jj);
-                            int vizviv = tabulIn[ind2d(ii - 1, jj - 1)] + tabulIn[ind2d(ii - 1, jj)] +
-                                         tabulIn[ind2d(ii - 1, jj + 1)] + tabulIn[ind2d(ii, jj - 1)] +
-                                         tabulIn[ind2d(ii, jj + 1)] + tabulIn[ind2d(ii + 1, jj - 1)] +
-                                         tabulIn[ind2d(ii + 1, jj)] + tabulIn[ind2d(ii + 1, jj + 1)];
-
-                            if (tabulIn[idx] && vizviv < 2)
-                                tabulOut[idx] = 0;
-                            else if (tabulIn[idx] && vizviv > 3)
-                                tabulOut[idx] = 0;
-                            else if (!tabulIn[idx] && vizviv == 3)
-                                tabulOut[idx] = 1;
-                            else
-                                tabulOut[idx] = tabulIn[idx];
-                        }
-                    }
-
-// Segunda evolucao: tabulOut -> tabulIn
-#pragma omp target teams distribute parallel for collapse(2)
-                    for (int ii = 1; ii <= tam; ii++)
-                    {
-                        for (int jj = 1; jj <= tam; jj++)
-                        {
-                            int idx = ind2d(ii, jj);
-                            int vizviv = tabulOut[ind2d(ii - 1, jj - 1)] + tabulOut[ind2d(ii - 1, jj)] +
-                                         tabulOut[ind2d(ii - 1, jj + 1)] + tabulOut[ind2d(ii, jj - 1)] +
-                                         tabulOut[ind2d(ii, jj + 1)] + tabulOut[ind2d(ii + 1, jj - 1)] +
-                                         tabulOut[ind2d(ii + 1, jj)] + tabulOut[ind2d(ii + 1, jj + 1)];
-
-                            if (tabulOut[idx] && vizviv < 2)
-                                tabulIn[idx] = 0;
-                            else if (tabulOut[idx] && vizviv > 3)
-                                tabulIn[idx] = 0;
-                            else if (!tabulOut[idx] && vizviv == 3)
-                                tabulIn[idx] = 1;
-                            else
-                                tabulIn[idx] = tabulOut[idx];
-                        }
-                    }
-                }
+                UmaVidaResidente(&td);
+                UmaVidaResidente(&td);
             }
         }
         else
         {
-            printf("Executando na CPU (sem GPU detectada)\n");
-#endif
-            // Fallback para CPU
             for (i = 0; i < 2 * (tam - 3); i++)
             {
-                UmaVidaOMPGPU(tabulIn, tabulOut, tam);
-                UmaVidaOMPGPU(tabulOut, tabulIn, tam);
+                UmaVidaMapeada(tabulIn, tabulOut, tam, dev);
+                UmaVidaMapeada(tabulOut, tabulIn, tam, dev);
             }
-#if GPU_AVAILABLE
         }
-#endif
 
         t2 = wall_time();
 
+        if (modo == MODO_RESIDENTE)
+        {
+            if (LerTabulDispositivo(&td, tabulIn) != 0)
+            {
+                printf("Erro na copia do dispositivo!\n");
+                exit(1);
+            }
+            LiberarTabulDispositivo(&td);
+        }
+
         // Verificacao do resultado
         if (Correto(tabulIn, tam))
             printf("**RESULTADO CORRETO**\n");
@@ -332,4 +370,4 @@ int main(void)
     }
 
     return 0;
-}
\ No newline at end of file
+}
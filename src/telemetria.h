@@ -0,0 +1,206 @@
+/* Telemetria ao vivo em memoria compartilhada POSIX (shm_open), escrita pelo
+   laco de computacao das versoes OpenMP e MPI e lida por jogodavida_top.
+   Um unico escritor por campo e stores atomicos relaxados: sem travas e sem
+   chamadas de sistema no laco; o leitor so mapeia o bloco para leitura. */
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TELEM_MAGICO 0x4d4c4554u // "TELM"
+#define TELEM_VERSAO 1
+#define TELEM_JANELA 0.1 // segundos entre atualizacoes de ger/s
+
+// Fases
+#define TELEM_INICIANDO 0
+#define TELEM_INIT 1
+#define TELEM_COMP 2
+#define TELEM_FIM 3
+#define TELEM_TERMINADO 4
+
+#define RELAXADO memory_order_relaxed
+
+/* Uma linha de cache por thread (OpenMP) ou processo (MPI) */
+typedef struct {
+    _Alignas(64) _Atomic int64_t geracao; // geracoes concluidas por este trabalhador
+    _Atomic int64_t itens;                // linhas (ou blocos, layout morton) calculadas
+    _Atomic int64_t populacao;            // vivas calculadas na ultima geracao
+    _Atomic double t_comm;                // MPI: tempo acumulado em comunicacao (s)
+    char pad[32];
+} TelemTrabalhador;
+
+typedef struct {
+    _Atomic uint32_t magico; // gravado por ultimo na criacao
+    uint32_t versao;
+    int32_t pid, ntrab;
+    char programa[16];
+    _Atomic int32_t fase, tam;
+    _Atomic int64_t geracao, total_geracoes;
+    _Atomic int64_t populacao; // -1: soma das populacoes dos trabalhadores
+    _Atomic double ger_por_seg;
+    _Atomic double t_init, t_comp, t_fim; // tempos do tamanho atual/ultimo
+    _Atomic double inicio_fase;           // wall time do inicio da fase atual
+    _Atomic double t_janela;              // estado da janela de ger/s (escritor)
+    _Atomic int64_t g_janela;
+    char pad[8];
+    TelemTrabalhador trab[];
+} Telemetria;
+
+static inline size_t TelemTamanho(int ntrab) {
+    return sizeof(Telemetria) + (size_t)ntrab * sizeof(TelemTrabalhador);
+}
+
+/* Nome do segmento: "/jogodavida_<nome>" */
+static inline void TelemNome(char *dst, size_t n, const char *nome) {
+    snprintf(dst, n, "/jogodavida_%s", nome);
+}
+
+/* Cria (ou recria) o segmento; retorna NULL em erro */
+static inline Telemetria *TelemCriar(const char *nome, const char *programa, int ntrab) {
+    char shm[256];
+    size_t tamanho = TelemTamanho(ntrab);
+    Telemetria *t;
+    int fd;
+
+    TelemNome(shm, sizeof(shm), nome);
+    fd = shm_open(shm, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, tamanho) != 0) {
+        close(fd);
+        return NULL;
+    }
+    t = (Telemetria *)mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (t == MAP_FAILED) {
+        return NULL;
+    }
+    memset(t, 0, tamanho);
+    t->versao = TELEM_VERSAO;
+    t->pid = getpid();
+    t->ntrab = ntrab;
+    snprintf(t->programa, sizeof(t->programa), "%s", programa);
+    atomic_store_explicit(&t->populacao, -1, RELAXADO);
+    atomic_store_explicit(&t->magico, TELEM_MAGICO, memory_order_release);
+    return t;
+}
+
+/* Abre um segmento existente (escrita: demais processos MPI; leitura:
+   jogodavida_top). Retorna NULL se nao existir ou nao for valido. */
+static inline Telemetria *TelemAbrir(const char *nome, int escrita) {
+    char shm[256];
+    struct stat st;
+    Telemetria *t;
+    int fd;
+
+    TelemNome(shm, sizeof(shm), nome);
+    fd = shm_open(shm, escrita ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Telemetria)) {
+        close(fd);
+        return NULL;
+    }
+    t = (Telemetria *)mmap(NULL, st.st_size, escrita ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (t == MAP_FAILED) {
+        return NULL;
+    }
+    if (atomic_load_explicit(&t->magico, memory_order_acquire) != TELEM_MAGICO || t->versao != TELEM_VERSAO ||
+        (size_t)st.st_size < TelemTamanho(t->ntrab)) {
+        munmap(t, st.st_size);
+        return NULL;
+    }
+    return t;
+}
+
+/* Desmapeia; com remover, apaga o nome (leitores ja conectados continuam
+   vendo o bloco ate desmapearem) */
+static inline void TelemFechar(Telemetria *t, const char *nome, int remover) {
+    char shm[256];
+
+    if (remover) {
+        atomic_store_explicit(&t->fase, TELEM_TERMINADO, RELAXADO);
+        TelemNome(shm, sizeof(shm), nome);
+        shm_unlink(shm);
+    }
+    munmap(t, TelemTamanho(t->ntrab));
+}
+
+static inline void TelemFase(Telemetria *t, int fase, double agora) {
+    atomic_store_explicit(&t->inicio_fase, agora, RELAXADO);
+    atomic_store_explicit(&t->fase, fase, RELAXADO);
+}
+
+/* Inicio de um tamanho: zera o slot do trabalhador (chamado pelo dono) */
+static inline void TelemZerarTrabalhador(Telemetria *t, int id) {
+    if (id < t->ntrab) {
+        atomic_store_explicit(&t->trab[id].geracao, 0, RELAXADO);
+        atomic_store_explicit(&t->trab[id].itens, 0, RELAXADO);
+        atomic_store_explicit(&t->trab[id].populacao, 0, RELAXADO);
+        atomic_store_explicit(&t->trab[id].t_comm, 0.0, RELAXADO);
+    }
+}
+
+/* Inicio de um tamanho: zera contadores e tempos do cabecalho */
+static inline void TelemTamanhoNovo(Telemetria *t, int tam, int64_t total_geracoes, double agora) {
+    atomic_store_explicit(&t->tam, tam, RELAXADO);
+    atomic_store_explicit(&t->total_geracoes, total_geracoes, RELAXADO);
+    atomic_store_explicit(&t->geracao, 0, RELAXADO);
+    atomic_store_explicit(&t->ger_por_seg, 0.0, RELAXADO);
+    atomic_store_explicit(&t->t_init, 0.0, RELAXADO);
+    atomic_store_explicit(&t->t_comp, 0.0, RELAXADO);
+    atomic_store_explicit(&t->t_fim, 0.0, RELAXADO);
+    atomic_store_explicit(&t->t_janela, agora, RELAXADO);
+    atomic_store_explicit(&t->g_janela, 0, RELAXADO);
+    TelemFase(t, TELEM_INIT, agora);
+}
+
+/* Geracao concluida (escritor principal); ger/s e atualizado quando a
+   janela de TELEM_JANELA segundos fecha */
+static inline void TelemGeracao(Telemetria *t, int64_t geracao, double agora) {
+    double t0 = atomic_load_explicit(&t->t_janela, RELAXADO);
+    int64_t g0 = atomic_load_explicit(&t->g_janela, RELAXADO);
+
+    atomic_store_explicit(&t->geracao, geracao, RELAXADO);
+    if (agora - t0 >= TELEM_JANELA) {
+        atomic_store_explicit(&t->ger_por_seg, (geracao - g0) / (agora - t0), RELAXADO);
+        atomic_store_explicit(&t->t_janela, agora, RELAXADO);
+        atomic_store_explicit(&t->g_janela, geracao, RELAXADO);
+    }
+}
+
+/* Progresso de um trabalhador (so ele escreve no proprio slot): itens
+   calculados e vivas entre eles, contadas pelo proprio kernel; a populacao
+   do tabuleiro e a soma dos slots */
+static inline void TelemTrabalho(Telemetria *t, int id, int64_t itens, int64_t populacao) {
+    TelemTrabalhador *w;
+
+    if (id < 0 || id >= t->ntrab) {
+        return;
+    }
+    w = &t->trab[id];
+    atomic_store_explicit(&w->itens, atomic_load_explicit(&w->itens, RELAXADO) + itens, RELAXADO);
+    atomic_store_explicit(&w->populacao, populacao, RELAXADO);
+    atomic_store_explicit(&w->geracao, atomic_load_explicit(&w->geracao, RELAXADO) + 1, RELAXADO);
+}
+
+static inline void TelemComm(Telemetria *t, int id, double dt) {
+    TelemTrabalhador *w;
+
+    if (id >= 0 && id < t->ntrab) {
+        w = &t->trab[id];
+        atomic_store_explicit(&w->t_comm, atomic_load_explicit(&w->t_comm, RELAXADO) + dt, RELAXADO);
+    }
+}
+
+#endif